@@ -8,10 +8,12 @@
 #include <reading.h>
 
 #include <chrono>
+#include <condition_variable>
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
 #include <iostream>
+#include <memory>
 #include <mutex>
 #include <string>
 #include <thread>
@@ -21,11 +23,32 @@
 
 #include "iec61850_client_config.hpp"
 #include "iec61850_client_connection.hpp"
+#include "iec61850_command_tracker.hpp"
+#include "iec61850_conversion_pool.hpp"
 
-#define BACKUP_CONNECTION_TIMEOUT 5000
+#define CONNECTION_RETRY_DELAY 100
+#define COMMAND_TRACKER_TICK 100
 
 class IEC61850Client;
 
+/* PIVOT tree of an exchange definition with placeholders for the value,
+ * quality and timestamp. A reading is a deep copy of the tree, the positions
+ * recorded while it was built address the nodes patched in the copy. */
+struct PivotTemplate
+{
+    std::unique_ptr<Datapoint> pivot;
+    size_t root;
+    size_t cdc;
+    size_t value;
+    size_t q;
+    size_t test;
+    size_t validity;
+    size_t detailQuality;
+    size_t t;
+    size_t secondSinceEpoch;
+    size_t fractionOfSecond;
+};
+
 class PivotTimestamp
 {
   public:
@@ -62,10 +85,25 @@ class PivotTimestamp
 
     static uint64_t GetCurrentTimeInMs ();
 
+    /* Stack-only encoding of a millisecond timestamp into the PIVOT
+     * SecondSinceEpoch and FractionOfSecond (1/2^24 s) fields */
+    static constexpr uint32_t
+    EncodeSecondSinceEpoch (uint64_t ms)
+    {
+        return (uint32_t)(ms / 1000LL);
+    }
+
+    static constexpr uint32_t
+    EncodeFractionOfSecond (uint64_t ms)
+    {
+        return (uint32_t)(ms % 1000LL) * 16777
+               + (((uint32_t)(ms % 1000LL) * 216) / 1000);
+    }
+
   private:
     void handleTimeQuality (Datapoint* timeQuality);
 
-    std::vector<uint8_t> m_valueArray = std::vector<uint8_t> (7);
+    uint8_t m_valueArray[7] = { 0 };
 
     int m_secondSinceEpoch;
     int m_fractionOfSecond;
@@ -134,16 +172,44 @@ class IEC61850Client
 
     void prepareConnections ();
 
-    void handleValue (std::string objRef, MmsValue* mmsValue,
-                      uint64_t timestamp);
-    void handleAllValues ();
+    static bool parseDataSetEntry (std::string entryName, std::string& objRef,
+                                   std::string& attribute,
+                                   FunctionalConstraint& fc);
+
+    void handleValue (DataExchangeDefinition* def,
+                      MmsValue* mmsValue, const std::string& attribute,
+                      FunctionalConstraint fc, uint64_t timestamp);
+    void handleAllValues (const std::shared_ptr<PollingGroup>& group);
+    void handleAllValuesBatched (const std::shared_ptr<PollingGroup>& group);
+    void handlePolledValue (DataExchangeDefinition* def,
+                            MmsValue* value, const std::string& attribute,
+                            FunctionalConstraint fc);
+    void convertAndSend (DataExchangeDefinition* def,
+                         MmsValue* value, const std::string& attribute,
+                         FunctionalConstraint fc, uint64_t timestamp,
+                         bool polled);
+    void drainConversions ();
 
     bool handleOperation (Datapoint* operation);
 
     void logIedClientError (IedClientError err, const std::string& info) const;
 
-    void sendCommandAck (const std::string& label, ControlModel mode,
-                         bool terminated);
+    static std::shared_ptr<PivotTemplate>
+    createPivotTemplate (const DataExchangeDefinition& def);
+
+    static CdcConverter cdcConverter (CDCTYPE type);
+    static const char* valueElementName (CDCTYPE type);
+
+    bool commandDispatched (uint64_t commandId);
+    void commandIgnored (uint64_t commandId);
+
+    void sendCommandAck (uint64_t commandId, const std::string& label,
+                         ControlModel mode, bool terminated);
+
+    void commandFailed (uint64_t commandId, const std::string& label,
+                        bool terminated);
+
+    void connectionStateChanged ();
 
   private:
     std::shared_ptr<std::vector<IEC61850ClientConnection*> > m_connections
@@ -168,67 +234,51 @@ class IEC61850Client
     std::thread* m_monitoringThread = nullptr;
     void _monitoringThread ();
 
+    std::mutex m_connectionEventLock;
+    std::condition_variable m_connectionEvent;
+    bool m_connectionEventPending = false;
+    void m_waitForConnectionEvent (uint64_t deadline);
+    void m_signalMonitoringThread ();
+
     bool m_started = false;
 
+    IEC61850ConversionPool* m_conversionPool = nullptr;
+
     IEC61850ClientConfig* m_config;
     IEC61850* m_iec61850;
 
-    template <class T>
-    Datapoint* m_createDatapoint (const std::string& label,
-                                  const std::string& objRef, T value,
-                                  Quality quality, uint64_t timestampMs);
     static int getRootFromCDC (const CDCTYPE cdc);
 
-    void addQualityDp (Datapoint* cdcDp, Quality quality) const;
-    void addTimestampDp (Datapoint* cdcDp, uint64_t timestampMs) const;
-    template <class T>
-    void addValueDp (Datapoint* cdcDp, CDCTYPE type, T value) const;
-
-    void m_handleMonitoringData (const std::string& objRef,
+    static void setQualityDp (const PivotTemplate& pivotTemplate,
+                              Datapoint* qualityDp, Quality quality);
+    static void setTimestampDp (const PivotTemplate& pivotTemplate,
+                                Datapoint* timestampDp, uint64_t timestampMs);
+    template <CDCTYPE cdc>
+    static Datapoint* m_convertCdc (const DataExchangeDefinition& def,
+                                    MmsValue* mmsvalue,
+                                    const std::string& attribute,
+                                    Quality quality, uint64_t timestamp);
+
+    void m_handleMonitoringData (DataExchangeDefinition* def,
                                  std::vector<Datapoint*>& datapoints,
-                                 const std::string& label, CDCTYPE type,
+                                 std::vector<std::string>& labels,
                                  MmsValue* mmsValue,
-                                 const std::string& variable,
-                                 FunctionalConstraint fc, uint64_t timestamp);
+                                 const std::string& attribute,
+                                 FunctionalConstraint fc, uint64_t timestamp,
+                                 bool polled = false);
+    bool m_polledValueChanged (DataExchangeDefinition* def, MmsValue* value,
+                               const std::string& attribute);
     Quality extractQuality (MmsValue* mmsvalue,
-                            MmsVariableSpecification* varSpec,
+                            const DataExchangeDefinition& def,
                             const std::string& attribute);
     uint64_t extractTimestamp (MmsValue* mmsvalue,
-                               MmsVariableSpecification* varSpec,
+                               const DataExchangeDefinition& def,
                                const std::string& attribute);
-    bool processDatapoint (CDCTYPE type, std::vector<Datapoint*>& datapoints,
-                           const std::string& label, const std::string& objRef,
-                           MmsValue* mmsvalue,
-                           MmsVariableSpecification* varSpec, Quality quality,
-                           uint64_t timestamp, const std::string& attribute);
     void cleanUpMmsValue (MmsValue* originalMmsVal, MmsValue* usedMmsVal);
-    bool processBooleanType (std::vector<Datapoint*>& datapoints,
-                             const std::string& label,
-                             const std::string& objRef, MmsValue* mmsvalue,
-                             MmsVariableSpecification* varSpec,
-                             Quality quality, uint64_t timestamp,
-                             const std::string& attribute,
-                             const char* elementName);
-    bool processBSCType (std::vector<Datapoint*>& datapoints,
-                         const std::string& label, const std::string& objRef,
-                         MmsValue* mmsvalue, MmsVariableSpecification* varSpec,
-                         Quality quality, uint64_t timestamp,
-                         const std::string& attribute,
-                         const char* elementName);
-    bool processAnalogType (std::vector<Datapoint*>& datapoints,
-                            const std::string& label,
-                            const std::string& objRef, MmsValue* mmsvalue,
-                            MmsVariableSpecification* varSpec, Quality quality,
-                            uint64_t timestamp, const std::string& attribute,
-                            const char* elementName);
-    bool processIntegerType (std::vector<Datapoint*>& datapoints,
-                             const std::string& label,
-                             const std::string& objRef, MmsValue* mmsvalue,
-                             MmsVariableSpecification* varSpec,
-                             Quality quality, uint64_t timestamp,
-                             const std::string& attribute,
-                             const char* elementName);
-    std::unordered_map<std::string, Datapoint*> m_outstandingCommands;
+    IEC61850CommandTracker m_commandTracker;
+    void m_expireCommands ();
+    void m_sendCommandAck (const std::string& label, Datapoint* operation,
+                           bool terminated, bool negative);
     FRIEND_TESTS
 };
 
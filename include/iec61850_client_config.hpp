@@ -1,17 +1,21 @@
 #ifndef IEC61850_CLIENT_CONFIG_H
 #define IEC61850_CLIENT_CONFIG_H
 
+#include "iec61850_spec_cache.hpp"
 #include "iec61850_utility.hpp"
 #include "libiec61850/iec61850_client.h"
 #include "rapidjson/document.h"
 #include "rapidjson/error/en.h"
 #include <gtest/gtest.h>
 #include <logger.h>
+#include <cstdint>
 #include <map>
 #include <memory>
 #include <unordered_map>
 #include <vector>
 
+class Datapoint;
+
 #define FRIEND_TESTS                                                          \
     FRIEND_TEST (ConnectionHandlingTest, SingleConnection);                   \
     FRIEND_TEST (ConnectionHandlingTest, SingleConnectionTLS);                \
@@ -24,11 +28,15 @@
     FRIEND_TEST (ReportingTest, ReportingWithStaticDataset);                  \
     FRIEND_TEST (ReportingTest, ReportingWithDynamicDataset);                 \
     FRIEND_TEST (ReportingTest, ReportingUpdateQuality);                      \
+    FRIEND_TEST (ReportingTest, ReportQueueFullNotLost);                      \
     FRIEND_TEST (ReportingTest, ReportingGI);                                 \
     FRIEND_TEST (ReportingTest, ReportingSetpointCommand);                    \
     FRIEND_TEST (ReportingTest, ReportingChangeValueMultipleTimes);           \
+    FRIEND_TEST (ReportingTest, ReportDispatchTable);                         \
     FRIEND_TEST (SpontDataTest, Polling);                                     \
     FRIEND_TEST (SpontDataTest, PollingAllCDC);                               \
+    FRIEND_TEST (SpontDataTest, PollingSharedObjRef);                         \
+    FRIEND_TEST (SpontDataTest, PollingSpecsFollowModel);                     \
     FRIEND_TEST (ControlTest, AnalogueCommandDirectNormal);                   \
     FRIEND_TEST (ControlTest, StepCommandDirectNormal);                       \
     FRIEND_TEST (ConfigTest, ProtocolConfigParseError);                       \
@@ -49,7 +57,40 @@
     FRIEND_TEST (ConfigTest, ProtocolConfigReportNoDataref);                  \
     FRIEND_TEST (ConfigTest, ProtocolConfigNoTrgroups);                       \
     FRIEND_TEST (ConfigTest, ProtocolConfigBuftmIntgpd);                      \
-    FRIEND_TEST (ConnectionHandlingTest, TwoConnectionsBackup);
+    FRIEND_TEST (ConfigTest, ProtocolConfigPollingMode);                      \
+    FRIEND_TEST (ConfigTest, ProtocolConfigWrongPollingMode);                 \
+    FRIEND_TEST (SpontDataTest, PollingBatched);                              \
+    FRIEND_TEST (SpontDataTest, PollingPipelined);                            \
+    FRIEND_TEST (ConfigTest, ProtocolConfigMaxOutstandingReads);              \
+    FRIEND_TEST (ConfigTest, ProtocolConfigPollingGroups);                    \
+    FRIEND_TEST (ConfigTest, ProtocolConfigWrongPollingGroups);               \
+    FRIEND_TEST (SpontDataTest, PollingGroups);                               \
+    FRIEND_TEST (SpontDataTest, PollingScheduleCadence);                      \
+    FRIEND_TEST (SpontDataTest, PollingChangeOnly);                           \
+    FRIEND_TEST (SpontDataTest, PolledValueChangedElements);                  \
+    FRIEND_TEST (ConfigTest, ProtocolConfigChangeOnly);                       \
+    FRIEND_TEST (ConfigTest, ProtocolConfigReportQueueSize);                  \
+    FRIEND_TEST (ReportingTest, ReportingSynchronous);                        \
+    FRIEND_TEST (ReportingTest, ReportingConversionPool);                     \
+    FRIEND_TEST (ReportingTest, DynamicDatasetUnchanged);                     \
+    FRIEND_TEST (ReportingTest, AutoReporting);                               \
+    FRIEND_TEST (ConfigTest, ProtocolConfigConversionWorkers);                \
+    FRIEND_TEST (ConfigTest, ProtocolConfigModelCache);                       \
+    FRIEND_TEST (ConfigTest, ProtocolConfigAutoReporting);                    \
+    FRIEND_TEST (ConfigTest, ProtocolConfigAssociations);                     \
+    FRIEND_TEST (ConfigTest, ProtocolConfigMinimalReads);                     \
+    FRIEND_TEST (SpontDataTest, PollingMinimalReads);                         \
+    FRIEND_TEST (ConnectionHandlingTest, ReadAssociations);                   \
+    FRIEND_TEST (ConnectionHandlingTest, LateVarSpecResponse);                \
+    FRIEND_TEST (ConnectionHandlingTest, TwoConnectionsBackup);               \
+    FRIEND_TEST (ConnectionHandlingTest, EventDrivenConnectionThread);        \
+    FRIEND_TEST (ControlTest, SingleCommandSboNormal);                        \
+    FRIEND_TEST (ControlTest, CommandContextsRecycled);                       \
+    FRIEND_TEST (ControlTest, CommandQueuePerObject);                         \
+    FRIEND_TEST (ControlTest, CommandTimeoutFromDispatch);                    \
+    FRIEND_TEST (ControlTest, LateResponseAfterTimeout);                      \
+    FRIEND_TEST (ConfigTest, ProtocolConfigMaxConcurrentCommands);            \
+    FRIEND_TEST (ConfigTest, ProtocolConfigCommandTimeout);
 
 typedef enum
 {
@@ -75,6 +116,13 @@ typedef enum
     ING
 } CDCTYPE;
 
+typedef enum
+{
+    POLLING_SEQUENTIAL,
+    POLLING_BATCHED,
+    POLLING_PIPELINED
+} POLLINGMODE;
+
 class ConfigurationException : public std::logic_error
 {
   public:
@@ -108,13 +156,89 @@ struct RedGroup
     bool tls;
 };
 
+/* Positions of the value, quality and timestamp components in the MMS
+ * structure of a data object, resolved once from its variable specification.
+ * -1 marks a component the specification does not contain. */
+struct DataElementIndices
+{
+    int value = -1;
+    int valueF = -1;
+    int valueI = -1;
+    int posVal = -1;
+    int transInd = -1;
+    int q = -1;
+    int t = -1;
+};
+
+/* Attribute under which the value, q and t attributes of a data object are
+ * handled when they were read as one variable list instead of the whole
+ * object. Its elements are addressed by DataExchangeDefinition::minimalElements
+ */
+#define MINIMAL_READ_ATTRIBUTE "[value,q,t]"
+
+struct DataExchangeDefinition;
+struct PivotTemplate;
+
+/* Converts the MMS value of a definition into its PIVOT datapoint, selected
+ * once per definition from its CDC */
+typedef Datapoint* (*CdcConverter) (const DataExchangeDefinition& def,
+                                    MmsValue* mmsvalue,
+                                    const std::string& attribute,
+                                    Quality quality, uint64_t timestamp);
+
 struct DataExchangeDefinition
 {
     std::string objRef;
     CDCTYPE cdcType;
     std::string label;
     std::string id;
+    uint32_t handle;
     MmsVariableSpecification* spec;
+    DataElementIndices elements;
+    // names of the attributes of a minimal read, in the order they are read
+    std::vector<std::string> minimalItems;
+    DataElementIndices minimalElements;
+    MmsValue* lastPolledValue;
+    uint64_t lastForwardTime;
+    // set up by the client from the CDC of the definition
+    std::shared_ptr<PivotTemplate> pivotTemplate;
+    CdcConverter converter;
+    // next definition with the same object reference, converted from the
+    // values read for this one
+    DataExchangeDefinition* nextSameObjRef;
+};
+
+/*
+ * Open-addressing hash index over one string member of the definitions in
+ * the exchange definition table. Slots hold table positions and keys are read
+ * from the definitions themselves, so the index does not copy any strings.
+ */
+class DefinitionIndex
+{
+  public:
+    explicit DefinitionIndex (const std::string DataExchangeDefinition::*key)
+        : m_key (key)
+    {
+    }
+
+    bool insert (const std::vector<DataExchangeDefinition>& definitions,
+                 uint32_t handle);
+    DataExchangeDefinition*
+    find (std::vector<DataExchangeDefinition>& definitions,
+          const std::string& key) const;
+    void clear ();
+
+  private:
+    static const uint32_t EMPTY_SLOT = UINT32_MAX;
+
+    size_t m_findSlot (const std::vector<DataExchangeDefinition>& definitions,
+                       const std::string& key) const;
+    void m_rehash (const std::vector<DataExchangeDefinition>& definitions,
+                   size_t slotCount);
+
+    const std::string DataExchangeDefinition::*m_key;
+    std::vector<uint32_t> m_slots;
+    size_t m_used = 0;
 };
 
 struct ReportSubscription
@@ -134,10 +258,18 @@ struct Dataset
     bool dynamic;
 };
 
+struct PollingGroup
+{
+    std::string name;
+    long interval;
+    std::vector<std::string> labels;
+    std::unordered_map<std::string, DataExchangeDefinition*> polledDatapoints;
+};
+
 class IEC61850ClientConfig
 {
   public:
-    IEC61850ClientConfig () { m_exchangeDefinitions.clear (); };
+    IEC61850ClientConfig () = default;
     ~IEC61850ClientConfig ();
 
     int
@@ -194,7 +326,7 @@ class IEC61850ClientConfig
 
     static int getCdcTypeFromString (const std::string& cdc);
 
-    std::unordered_map<std::string, std::shared_ptr<DataExchangeDefinition> >&
+    std::vector<DataExchangeDefinition>&
     ExchangeDefinition ()
     {
         return m_exchangeDefinitions;
@@ -204,11 +336,25 @@ class IEC61850ClientConfig
 
     std::string* checkExchangeDataLayer (int typeId, std::string& objRef);
 
-    std::shared_ptr<DataExchangeDefinition>
+    DataExchangeDefinition* getExchangeDefinition (uint32_t handle);
+
+    MmsSpecCache&
+    specCache ()
+    {
+        return m_specCache;
+    };
+    // endpoint and model identity the variable specifications were read from
+    const std::string&
+    specSource () const
+    {
+        return m_specSource;
+    };
+    void resetVariableSpecs (const std::string& source);
+    DataExchangeDefinition*
     getExchangeDefinitionByLabel (const std::string& label);
-    std::shared_ptr<DataExchangeDefinition>
+    DataExchangeDefinition*
     getExchangeDefinitionByPivotId (const std::string& pivotId);
-    std::shared_ptr<DataExchangeDefinition>
+    DataExchangeDefinition*
     getExchangeDefinitionByObjRef (const std::string& objRef);
 
     const std::unordered_map<std::string,
@@ -222,8 +368,7 @@ class IEC61850ClientConfig
     {
         return m_datasets;
     };
-    const std::unordered_map<std::string,
-                             std::shared_ptr<DataExchangeDefinition> >&
+    const std::unordered_map<std::string, DataExchangeDefinition*>&
     polledDatapoints () const
     {
         return m_polledDatapoints;
@@ -235,6 +380,91 @@ class IEC61850ClientConfig
         return pollingInterval;
     }
 
+    const std::vector<std::shared_ptr<PollingGroup> >&
+    getPollingGroups () const
+    {
+        return m_pollingGroups;
+    };
+
+    POLLINGMODE
+    getPollingMode () const
+    {
+        return m_pollingMode;
+    };
+
+    bool
+    getChangeOnly () const
+    {
+        return m_changeOnly;
+    };
+
+    long
+    getForcedRefresh () const
+    {
+        return m_forcedRefresh;
+    };
+
+    int
+    getConversionWorkers () const
+    {
+        return m_conversionWorkers;
+    };
+
+    int
+    getReportQueueSize () const
+    {
+        return m_reportQueueSize;
+    };
+
+    const std::string&
+    getModelCacheDir () const
+    {
+        return m_modelCacheDir;
+    };
+
+    int
+    getAssociations () const
+    {
+        return m_associations;
+    };
+
+    bool
+    getMinimalReads () const
+    {
+        return m_minimalReads;
+    };
+
+    bool
+    getAutoReporting () const
+    {
+        return m_autoReporting;
+    };
+
+    int
+    getMaxDatasetEntries () const
+    {
+        return m_maxDatasetEntries;
+    };
+
+    int
+    getMaxOutstandingReads () const
+    {
+        return m_maxOutstandingReads;
+    };
+
+    int
+    getMaxConcurrentCommands () const
+    {
+        return m_maxConcurrentCommands;
+    };
+
+    // milliseconds until an unacknowledged command is given up
+    uint64_t
+    getCommandTimeout () const
+    {
+        return m_commandTimeout;
+    };
+
     uint64_t
     backupConnectionTimeout ()
     {
@@ -247,16 +477,22 @@ class IEC61850ClientConfig
     std::vector<std::shared_ptr<RedGroup> > m_connections;
 
     void deleteExchangeDefinitions ();
+    void importJsonPollingGroups (const rapidjson::Value& pollingGroups);
+    void assignPollingGroups ();
 
-    std::unordered_map<std::string, std::shared_ptr<DataExchangeDefinition> >
-        m_polledDatapoints;
+    std::unordered_map<std::string, DataExchangeDefinition*> m_polledDatapoints;
     std::unordered_map<std::string, std::shared_ptr<Dataset> > m_datasets;
-    std::unordered_map<std::string, std::shared_ptr<DataExchangeDefinition> >
-        m_exchangeDefinitions;
-    std::unordered_map<std::string, std::shared_ptr<DataExchangeDefinition> >
-        m_exchangeDefinitionsPivotId;
-    std::unordered_map<std::string, std::shared_ptr<DataExchangeDefinition> >
-        m_exchangeDefinitionsObjRef;
+    std::vector<std::shared_ptr<PollingGroup> > m_pollingGroups;
+    // definitions are addressed by their position (handle) in this table,
+    // which does not change between two imports of the exchange config
+    std::vector<DataExchangeDefinition> m_exchangeDefinitions;
+    DefinitionIndex m_exchangeDefinitionsLabel{ &DataExchangeDefinition::label };
+    DefinitionIndex m_exchangeDefinitionsPivotId{ &DataExchangeDefinition::id };
+    DefinitionIndex m_exchangeDefinitionsObjRef{
+        &DataExchangeDefinition::objRef
+    };
+    MmsSpecCache m_specCache;
+    std::string m_specSource;
 
     std::unordered_map<std::string, std::shared_ptr<ReportSubscription> >
         m_reportSubscriptions;
@@ -272,6 +508,19 @@ class IEC61850ClientConfig
     uint64_t m_backupConnectionTimeout = 5000;
 
     long pollingInterval = 0;
+    POLLINGMODE m_pollingMode = POLLING_SEQUENTIAL;
+    int m_maxOutstandingReads = 8;
+    int m_associations = 1;
+    int m_maxConcurrentCommands = 16;
+    uint64_t m_commandTimeout = 30000;
+    bool m_minimalReads = false;
+    bool m_changeOnly = false;
+    int m_reportQueueSize = 1024;
+    int m_conversionWorkers = 0;
+    std::string m_modelCacheDir;
+    bool m_autoReporting = false;
+    int m_maxDatasetEntries = 100;
+    long m_forcedRefresh = 0;
     FRIEND_TESTS
 };
 
@@ -3,13 +3,31 @@
 
 #include "datapoint.h"
 #include "iec61850_client_config.hpp"
+#include "iec61850_model_cache.hpp"
+#include "iec61850_spsc_queue.hpp"
+#include <atomic>
+#include <condition_variable>
+#include <deque>
 #include <gtest/gtest.h>
 #include <libiec61850/iec61850_client.h>
+#include <map>
 #include <mutex>
 #include <thread>
+#include <unordered_set>
 
 class IEC61850Client;
 
+struct PollBatch
+{
+    const PollingGroup* group;
+    std::string domainId;
+    FunctionalConstraint fc;
+    std::vector<DataExchangeDefinition*> definitions;
+    // variables read per definition, 0 for the whole data object
+    std::vector<int> itemCounts;
+    LinkedList itemIds;
+};
+
 class IEC61850ClientConnection
 {
   public:
@@ -57,11 +75,30 @@ class IEC61850ClientConnection
     MmsValue* readDatasetValues (IedClientError* error,
                                  const char* datasetRef);
 
+    MmsValue* readPollBatch (IedClientError* error, const PollBatch* batch);
+
+    MmsValue* readMinimal (IedClientError* error,
+                           const DataExchangeDefinition* def,
+                           FunctionalConstraint fc);
+
+    static bool hasDataAccessError (MmsValue* value);
+
+    const std::vector<PollBatch*>&
+    pollBatches () const
+    {
+        return m_pollBatches;
+    };
+
+    void pollPipelined (const PollingGroup* group);
+
     MmsVariableSpecification* getVariableSpec (IedClientError* error,
                                                const char* objRef,
                                                FunctionalConstraint fc);
 
-    bool operate (const std::string& objRef, DatapointValue value);
+    bool operate (const std::string& objRef, DatapointValue value,
+                  uint64_t commandId);
+
+    size_t pendingControls ();
 
     static void writeHandler (uint32_t invokeId, void* parameter,
                               IedClientError err);
@@ -69,6 +106,32 @@ class IEC61850ClientConnection
     bool writeValue (Datapoint* operation, const std::string& objRef, DatapointValue value,
                      CDCTYPE type);
 
+    size_t
+    reportQueueDepth () const
+    {
+        return m_reportQueue ? m_reportQueue->size () : 0;
+    };
+
+    size_t
+    reportQueueHighWaterMark () const
+    {
+        return m_reportQueueHighWaterMark;
+    };
+
+    // times the queue was full and delivered on the receive thread
+    uint64_t
+    reportQueueStalls () const
+    {
+        return m_reportQueueStalls;
+    };
+
+    // milliseconds from association to the first report, -1 before that
+    int64_t
+    timeToFirstReport () const
+    {
+        return m_timeToFirstReport;
+    };
+
     const std::string&
     IP ()
     {
@@ -101,6 +164,12 @@ class IEC61850ClientConnection
                                       MmsError err,
                                       MmsDataAccessError accessError);
 
+    static void readObjectHandler (uint32_t invokeId, void* parameter,
+                                   IedClientError err, MmsValue* value);
+
+    static void readVariablesHandler (uint32_t invokeId, void* parameter,
+                                      MmsError err, MmsValue* value);
+
     using ConState = enum {
         CON_STATE_IDLE,
         CON_STATE_CONNECTING,
@@ -121,6 +190,20 @@ class IEC61850ClientConnection
         CONTROL_WAIT_FOR_ACT_TERM
     };
 
+    struct QueuedControl
+    {
+        DatapointValue value;
+        uint64_t commandId;
+    };
+
+    // a command that could not be sent, reported once m_controlLock is
+    // released
+    struct FailedControl
+    {
+        uint64_t commandId;
+        std::string label;
+    };
+
     using ControlObjectStruct = struct
     {
         ControlObjectClient client;
@@ -128,19 +211,240 @@ class IEC61850ClientConnection
         ControlModel mode;
         MmsValue* value;
         std::string label;
+        // commands waiting for the one in flight on this object
+        std::deque<QueuedControl> queue;
+        bool ready;
     };
 
     std::unordered_map<std::string, ControlObjectStruct*> m_controlObjects;
-    std::vector<std::pair<IEC61850ClientConnection*, LinkedList>*>
-        m_connDataSetDirectoryPairs;
-    std::vector<std::pair<IEC61850ClientConnection*, ControlObjectStruct*>*>
-        m_connControlPairs;
+
+    // handler parameter of a command, taken from a pool that is sized once
+    // per association and recycled on ActCon, ActTerm, failure or timeout.
+    // A command that times out while its select or operate is outstanding
+    // keeps its context until libiec61850 answers.
+    struct CommandContext
+    {
+        IEC61850ClientConnection* connection;
+        ControlObjectStruct* cos;
+        uint64_t deadline;
+        uint64_t commandId;
+        uint64_t dispatchTime;
+        bool responsePending;
+        bool expired;
+    };
+
+    std::vector<CommandContext> m_commandContexts;
+    std::vector<CommandContext*> m_freeCommandContexts;
+
+    // contexts of the commands in flight
+    std::unordered_set<CommandContext*> m_pendingControls;
+    // objects with queued commands that wait for a free command slot
+    std::deque<ControlObjectStruct*> m_readyControls;
+    std::mutex m_controlLock;
+    void m_prepareCommandContexts ();
+    CommandContext* m_acquireCommandContext (ControlObjectStruct* cos);
+    void m_releaseCommandContext (CommandContext* context);
+    bool m_completeTermination (CommandContext* context,
+                                ControlObjectClient client,
+                                ControlObjectStruct*& cos,
+                                uint64_t& commandId);
+    void m_expireCommandContexts (uint64_t currentTime);
+    void m_controlIdle (ControlObjectStruct* cos);
+    void m_dispatchControls (std::vector<FailedControl>& failed);
+    bool m_issueControl (ControlObjectStruct* co, QueuedControl& command);
+    void m_reportFailedControls (const std::vector<FailedControl>& failed);
+
+    struct ReportEntry
+    {
+        DataExchangeDefinition* def;
+        std::string attribute;
+        FunctionalConstraint fc;
+    };
+
+    struct ReportDispatchTable
+    {
+        IEC61850ClientConnection* connection;
+        std::vector<ReportEntry> entries;
+    };
+
+    std::vector<ReportDispatchTable*> m_reportDispatchTables;
+
+    struct QueuedReportValue
+    {
+        const ReportEntry* entry;
+        MmsValue* value;
+        uint64_t timestamp;
+    };
+
+    SpscQueue<QueuedReportValue>* m_reportQueue = nullptr;
+    std::atomic<size_t> m_reportQueueHighWaterMark{ 0 };
+    std::atomic<uint64_t> m_reportQueueStalls{ 0 };
+    std::mutex m_reportDrainLock;
+    std::mutex m_reportWaitLock;
+    std::condition_variable m_reportAvailable;
+    bool m_reportThreadStop = false;
+    std::thread* m_reportThread = nullptr;
+    void _reportThread ();
+    void m_enqueueReportValue (const ReportEntry* entry, MmsValue* value,
+                               uint64_t timestamp);
+    void m_drainReportQueue ();
+    std::vector<PollBatch*> m_pollBatches;
+
+    struct PollSchedule
+    {
+        std::shared_ptr<PollingGroup> group;
+        std::vector<std::shared_ptr<PollingGroup> > slices;
+        uint64_t nextPollingTime;
+        uint64_t cycleStart;
+        size_t nextSlice;
+        uint64_t overruns;
+        uint64_t skippedCycles;
+    };
+
+    std::vector<PollSchedule> m_pollSchedules;
+
+    struct PipelinedGroup
+    {
+        const PollingGroup* group;
+        std::vector<DataExchangeDefinition*> definitions;
+        size_t nextPollIndex;
+        int outstandingReads;
+    };
+
+    // additional association to the IED that only carries bulk reads, so
+    // that control and reporting on m_connection never queue behind them
+    struct ReadAssociation
+    {
+        IedConnection connection;
+        int outstanding;
+    };
+
+    std::vector<ReadAssociation> m_readAssociations;
+    std::mutex m_readAssociationLock;
+    std::mutex m_readAssociationWaitLock;
+    std::condition_variable m_readAssociationStateChanged;
+    uint64_t m_readAssociationStateChanges = 0;
+    static void readAssociationStateHandler (void* parameter,
+                                             IedConnection connection,
+                                             IedConnectionState newState);
+    IedConnection m_createAssociation ();
+    void m_openReadAssociations ();
+    void m_awaitReadAssociations ();
+    void m_closeReadAssociations ();
+    ReadAssociation* m_acquireReadAssociation ();
+    void m_releaseReadAssociation (ReadAssociation* association);
+    IedConnection m_readConnection ();
+    int m_readWindow () const;
+
+    struct PendingRead
+    {
+        IEC61850ClientConnection* connection;
+        PipelinedGroup* group;
+        DataExchangeDefinition* def;
+        FunctionalConstraint fc;
+        ReadAssociation* association;
+    };
+
+    std::vector<PipelinedGroup> m_pipelinedGroups;
+    std::vector<PendingRead> m_pendingReads;
+    std::vector<PendingRead*> m_freeReadSlots;
 
     void m_initialiseControlObjects ();
-    void m_configDatasets ();
+    bool m_provisionDataset (const Dataset& dataset, bool& created);
+    int m_configDatasets ();
+    bool m_subscribeReport (const std::shared_ptr<ReportSubscription>& rs);
     void m_configRcb ();
-    void m_setVarSpecs ();
-    void m_setOsiConnectionParameters ();
+
+    struct PlannedReport
+    {
+        std::shared_ptr<ReportSubscription> subscription;
+        std::vector<DataExchangeDefinition*> definitions;
+    };
+
+    std::vector<PlannedReport> m_plannedReports;
+    std::unordered_set<DataExchangeDefinition*> m_reportedDefinitions;
+    std::deque<std::string> m_findFreeRcbs (const std::string& ldName);
+    void m_planReports ();
+    ReportDispatchTable* m_createReportDispatchTable (
+        LinkedList dataSetDirectory);
+
+    struct PendingSpec
+    {
+        DataExchangeDefinition* def;
+        FunctionalConstraint fc;
+        MmsVariableSpecification* spec;
+    };
+
+    // parameter of an issued request; it outlives m_specRequests, which the
+    // bring-up clears when it stops waiting, and is released by the response
+    // or once the connection is destroyed
+    struct SpecCall
+    {
+        IEC61850ClientConnection* connection;
+        uint64_t generation;
+        size_t request;
+        ReadAssociation* association;
+    };
+
+    std::vector<PendingSpec> m_specRequests;
+    std::unordered_set<SpecCall*> m_specCalls;
+    uint64_t m_specGeneration = 0;
+    size_t m_nextSpecRequest = 0;
+    int m_outstandingSpecRequests = 0;
+    bool m_specRequestsOpen = false;
+    std::mutex m_specLock;
+    std::condition_variable m_specsReceived;
+    void m_requestVarSpecs ();
+    bool m_issueNextSpecRequest ();
+    void m_awaitVarSpecs ();
+    static void varSpecHandler (uint32_t invokeId, void* parameter,
+                                IedClientError err,
+                                MmsVariableSpecification* spec);
+
+    uint64_t m_associatedTime = 0;
+    std::atomic<bool> m_firstReportPending{ false };
+    std::atomic<int64_t> m_timeToFirstReport{ -1 };
+
+    IEC61850ModelCache* m_modelCache = nullptr;
+    bool m_modelCacheValid = false;
+    std::string m_modelSource;
+
+    // parameter of an issued configRev read, released by the response or
+    // once the connection is destroyed
+    struct IdentityCall
+    {
+        IEC61850ClientConnection* connection;
+        uint64_t generation;
+        std::string logicalDevice;
+    };
+
+    std::map<std::string, std::string> m_configRevisions;
+    std::unordered_set<IdentityCall*> m_identityCalls;
+    uint64_t m_identityGeneration = 0;
+    int m_outstandingIdentityReads = 0;
+    bool m_identityUnknown = false;
+    std::mutex m_identityLock;
+    std::condition_variable m_identityReceived;
+    void m_requestModelIdentity ();
+    std::string m_awaitModelIdentity ();
+    static void configRevHandler (uint32_t invokeId, void* parameter,
+                                  IedClientError err, MmsValue* value);
+    void m_validateModelCache ();
+    void m_saveModelCache ();
+    LinkedList m_getDataSetDirectory (IedClientError* error,
+                                      const std::string& dataSetRef);
+    void m_preparePollSchedules ();
+    void m_runPollSchedule (PollSchedule& schedule, uint64_t currentTime);
+    bool m_pollCycleRunning (const PollSchedule& schedule);
+    void m_preparePollBatches ();
+    void m_preparePollBatches (const PollingGroup* pollingGroup, int budget);
+    void m_preparePipelinedPolling ();
+    bool m_issueNextRead ();
+    void m_completeRead (PendingRead* slot, IedClientError err,
+                         MmsValue* value, const std::string& attribute);
+    void m_abortPipelinedPolling ();
+    void m_resetPipelinedPolling ();
+    void m_setOsiConnectionParameters (IedConnection connection);
 
     OsiParameters* m_osiParameters;
     int m_tcpPort;
@@ -155,24 +459,40 @@ class IEC61850ClientConnection
 
     std::mutex m_conLock;
     std::mutex m_reportLock;
+    std::mutex m_pollLock;
 
     uint64_t m_delayExpirationTime;
 
-    uint64_t m_nextPollingTime = 0;
-
     std::thread* m_conThread = nullptr;
     void _conThread ();
 
+    // the connection thread sleeps until its next deadline or until one of
+    // the events that can advance its state machine wakes it up
+    std::mutex m_wakeUpLock;
+    std::condition_variable m_wakeUpEvent;
+    bool m_wakeUpPending = false;
+    void m_wakeUp ();
+    uint64_t m_nextWakeUpTime ();
+    void m_waitForWakeUp (uint64_t wakeUpTime);
+    static void stateChangedHandler (void* parameter, IedConnection connection,
+                                     IedConnectionState newState);
+
     bool m_connect = false;
+    // set by Disconnect (), the connection thread closes the connection
+    bool m_disconnectPending = false;
+    void m_closeConnection ();
+    // requests to the IED that set up control, datasets, reports and polling
+    // on a new association; runs on the connection thread without m_conLock
+    void m_bringUp ();
     bool m_disconnect = false;
 
     static void controlActionHandler (uint32_t invokeId, void* parameter,
                                       IedClientError err,
                                       ControlActionType type, bool success);
 
-    void sendActCon (const ControlObjectStruct* cos);
+    void sendActCon (const ControlObjectStruct* cos, uint64_t commandId);
 
-    void sendActTerm (const ControlObjectStruct* cos);
+    void sendActTerm (const ControlObjectStruct* cos, uint64_t commandId);
 
     static void commandTerminationHandler (void* parameter,
                                            ControlObjectClient connection);
@@ -0,0 +1,107 @@
+#ifndef IEC61850_COMMAND_TRACKER_H
+#define IEC61850_COMMAND_TRACKER_H
+
+#include "datapoint.h"
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+struct TrackedCommand
+{
+    uint64_t id;
+    std::string label;
+    std::shared_ptr<Datapoint> operation;
+    bool confirmed;
+    // the deadline only runs once the command is sent
+    bool scheduled;
+    uint64_t expiryTick;
+    // position in the timer wheel, for removal in constant time
+    int level;
+    size_t slot;
+    std::list<TrackedCommand*>::iterator position;
+};
+
+/*
+ * Hierarchical timer wheel with WHEEL_LEVELS levels of WHEEL_SLOTS slots.
+ *
+ * Level 0 has one slot per tick. Every slot of a higher level covers a full
+ * turn of the level below it and is cascaded down when that level wraps
+ * around, so that scheduling, cancelling and expiring a timer are O(1)
+ * regardless of how many are running.
+ */
+class CommandTimerWheel
+{
+  public:
+    static const int WHEEL_LEVELS = 3;
+    static const int WHEEL_BITS = 6;
+    static const size_t WHEEL_SLOTS = 1 << WHEEL_BITS;
+
+    explicit CommandTimerWheel (uint64_t currentTick);
+
+    void schedule (TrackedCommand* command);
+    void cancel (TrackedCommand* command);
+    void advance (uint64_t tick, std::vector<TrackedCommand*>& expired);
+
+    size_t
+    size () const
+    {
+        return m_size;
+    };
+
+  private:
+    std::vector<std::list<TrackedCommand*> > m_slots[WHEEL_LEVELS];
+    uint64_t m_currentTick;
+    size_t m_size = 0;
+
+    void m_insert (TrackedCommand* command, uint64_t earliestTick);
+    void m_cascade (int level);
+};
+
+/*
+ * Outstanding commands by id, with a deadline for each of them once they
+ * are sent.
+ *
+ * Shared by the thread that receives operations, the MMS callbacks that
+ * acknowledge them and the thread that expires them.
+ */
+class IEC61850CommandTracker
+{
+  public:
+    IEC61850CommandTracker (uint64_t tickMs, uint64_t currentTime);
+
+    uint64_t add (const std::string& label, Datapoint* operation);
+    uint64_t add (const std::string& label, Datapoint* operation,
+                  uint64_t timeout, uint64_t currentTime);
+
+    bool schedule (uint64_t id, uint64_t timeout, uint64_t currentTime);
+
+    std::shared_ptr<Datapoint> acknowledge (uint64_t id, bool complete);
+
+    void remove (uint64_t id);
+
+    void expire (uint64_t currentTime,
+                 std::vector<std::unique_ptr<TrackedCommand> >& expired);
+
+    size_t size ();
+    size_t scheduled ();
+
+  private:
+    std::mutex m_lock;
+    uint64_t m_tickMs;
+    uint64_t m_nextId = 1;
+    CommandTimerWheel m_wheel;
+
+    typedef std::unordered_map<uint64_t, std::unique_ptr<TrackedCommand> >
+        CommandMap;
+    CommandMap m_commands;
+
+    void m_schedule (TrackedCommand* command, uint64_t timeout,
+                     uint64_t currentTime);
+    void m_erase (CommandMap::iterator it);
+};
+
+#endif /* IEC61850_COMMAND_TRACKER_H */
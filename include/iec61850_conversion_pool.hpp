@@ -0,0 +1,68 @@
+#ifndef IEC61850_CONVERSION_POOL_H
+#define IEC61850_CONVERSION_POOL_H
+
+#include "iec61850_client_config.hpp"
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <gtest/gtest.h>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class IEC61850Client;
+
+struct ConversionTask
+{
+    DataExchangeDefinition* def;
+    MmsValue* value;
+    std::string attribute;
+    FunctionalConstraint fc;
+    uint64_t timestamp;
+    bool polled;
+};
+
+/*
+ * Worker threads that convert monitoring values to PIVOT and ingest them.
+ * Tasks are sharded by the handle of the exchange definition, so values of
+ * the same data object are always handled in order by the same worker.
+ */
+class IEC61850ConversionPool
+{
+  public:
+    IEC61850ConversionPool (IEC61850Client* client, int workerCount);
+
+    ~IEC61850ConversionPool ();
+
+    void submit (ConversionTask&& task);
+
+    // wait until every task submitted so far has been converted
+    void drain ();
+
+    size_t
+    workerCount () const
+    {
+        return m_workers.size ();
+    };
+
+  private:
+    struct Worker
+    {
+        std::mutex lock;
+        std::condition_variable available;
+        std::condition_variable idle;
+        std::deque<ConversionTask> tasks;
+        bool busy = false;
+        std::thread* thread = nullptr;
+    };
+
+    void _workerThread (Worker* worker);
+
+    IEC61850Client* m_client;
+    std::vector<Worker*> m_workers;
+    std::atomic<bool> m_running{ true };
+
+    FRIEND_TESTS
+};
+
+#endif /* IEC61850_CONVERSION_POOL_H */
@@ -0,0 +1,78 @@
+#ifndef IEC61850_MODEL_CACHE_H
+#define IEC61850_MODEL_CACHE_H
+
+#include "libiec61850/iec61850_client.h"
+#include "rapidjson/document.h"
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/*
+ * On-disk cache of the parts of an IED model the client discovers on every
+ * connect: variable specifications, control models and data set
+ * directories. One file is kept per IED address. Its contents are only
+ * reused while the model identity (the configRev of the logical devices)
+ * matches the identity the IED reports on connect.
+ */
+class IEC61850ModelCache
+{
+  public:
+    IEC61850ModelCache (const std::string& directory, const std::string& ip,
+                        int port);
+    ~IEC61850ModelCache ();
+
+    IEC61850ModelCache (const IEC61850ModelCache&) = delete;
+    IEC61850ModelCache& operator= (const IEC61850ModelCache&) = delete;
+
+    bool validate (const std::string& identity);
+    bool save ();
+
+    MmsVariableSpecification* getSpec (const std::string& objRef,
+                                       FunctionalConstraint fc) const;
+    void putSpec (const std::string& objRef, FunctionalConstraint fc,
+                  MmsVariableSpecification* spec);
+
+    bool getControlModel (const std::string& objRef,
+                          ControlModel& mode) const;
+    void putControlModel (const std::string& objRef, ControlModel mode);
+
+    bool getDataSetDirectory (const std::string& dataSetRef,
+                              std::vector<std::string>& entries) const;
+    void putDataSetDirectory (const std::string& dataSetRef,
+                              const std::vector<std::string>& entries);
+
+    const std::string&
+    path () const
+    {
+        return m_path;
+    };
+
+    bool
+    dirty () const
+    {
+        return m_dirty;
+    };
+
+    static MmsVariableSpecification*
+    copySpec (MmsVariableSpecification* spec);
+
+  private:
+    static std::string m_specKey (const std::string& objRef,
+                                  FunctionalConstraint fc);
+    static MmsVariableSpecification*
+    m_parseSpec (const rapidjson::Value& value);
+
+    void m_load ();
+    void m_clear ();
+
+    std::string m_path;
+    std::string m_identity;
+    bool m_loaded = false;
+    bool m_dirty = false;
+
+    std::unordered_map<std::string, MmsVariableSpecification*> m_specs;
+    std::unordered_map<std::string, int> m_controlModels;
+    std::unordered_map<std::string, std::vector<std::string> > m_dataSets;
+};
+
+#endif /* IEC61850_MODEL_CACHE_H */
@@ -0,0 +1,51 @@
+#ifndef IEC61850_REPORT_PLANNER_H
+#define IEC61850_REPORT_PLANNER_H
+
+#include "iec61850_client_config.hpp"
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+struct PlannedDataset
+{
+    std::string ldName;
+    FunctionalConstraint fc;
+    size_t offset;
+    std::shared_ptr<Dataset> dataset;
+    std::vector<DataExchangeDefinition*> definitions;
+};
+
+/*
+ * Plans dynamic datasets for the datapoints that are not covered by a
+ * configured dataset, so that they can be reported instead of polled.
+ *
+ * Definitions are grouped by logical device and functional constraint and
+ * sorted by object reference. Each group is cut into datasets of at most
+ * maxEntries members, named after their offset in the group. The names
+ * therefore stay the same over reconnects as long as the configuration does,
+ * and a dataset that the server rejects can be split without renaming the
+ * others.
+ */
+class IEC61850ReportPlanner
+{
+  public:
+    static std::vector<PlannedDataset> plan (
+        const std::unordered_map<std::string, DataExchangeDefinition*>&
+            definitions,
+        size_t maxEntries);
+
+    static bool split (const PlannedDataset& planned, PlannedDataset& first,
+                       PlannedDataset& second);
+
+    static std::string datasetRef (const std::string& ldName,
+                                   FunctionalConstraint fc, size_t offset);
+
+  private:
+    static PlannedDataset m_createDataset (
+        const std::string& ldName, FunctionalConstraint fc, size_t offset,
+        std::vector<DataExchangeDefinition*>::const_iterator first,
+        std::vector<DataExchangeDefinition*>::const_iterator last);
+};
+
+#endif /* IEC61850_REPORT_PLANNER_H */
@@ -0,0 +1,42 @@
+#ifndef IEC61850_SPEC_CACHE_H
+#define IEC61850_SPEC_CACHE_H
+
+#include "libiec61850/iec61850_client.h"
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+/*
+ * Deduplicates structurally identical variable specifications.
+ *
+ * Data objects of the same type have identical specification trees that
+ * only differ in the name of their root. intern () keeps one shared tree per
+ * structure and destroys the duplicates, so definitions of the same type all
+ * point to the same specification. The cache owns every specification it
+ * returns until clear () is called.
+ */
+class MmsSpecCache
+{
+  public:
+    MmsSpecCache () = default;
+    ~MmsSpecCache ();
+
+    MmsSpecCache (const MmsSpecCache&) = delete;
+    MmsSpecCache& operator= (const MmsSpecCache&) = delete;
+
+    MmsVariableSpecification* intern (MmsVariableSpecification* spec);
+    void clear ();
+
+    size_t size ();
+
+    static std::string signature (MmsVariableSpecification* spec);
+
+  private:
+    static void m_appendSignature (MmsVariableSpecification* spec,
+                                   std::string& signature, bool root);
+
+    std::mutex m_lock;
+    std::unordered_map<std::string, MmsVariableSpecification*> m_specs;
+};
+
+#endif /* IEC61850_SPEC_CACHE_H */
@@ -0,0 +1,102 @@
+#ifndef IEC61850_SPSC_QUEUE_H
+#define IEC61850_SPSC_QUEUE_H
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+/*
+ * Bounded lock-free queue for exactly one producer and one consumer thread.
+ *
+ * Slots are preallocated and filled in place: the producer calls reserve ()
+ * and commit (), the consumer front () and pop (). Slot contents are kept
+ * when an element is consumed so that they can be reused by the producer.
+ */
+template <class T> class SpscQueue
+{
+  public:
+    explicit SpscQueue (size_t capacity)
+        : m_slots (roundUpToPowerOfTwo (capacity)),
+          m_mask (m_slots.size () - 1)
+    {
+    }
+
+    SpscQueue (const SpscQueue&) = delete;
+    SpscQueue& operator= (const SpscQueue&) = delete;
+
+    T*
+    reserve ()
+    {
+        size_t head = m_head.load (std::memory_order_relaxed);
+
+        if (head - m_tail.load (std::memory_order_acquire) == m_slots.size ())
+            return nullptr;
+
+        return &m_slots[head & m_mask];
+    }
+
+    void
+    commit ()
+    {
+        m_head.store (m_head.load (std::memory_order_relaxed) + 1,
+                      std::memory_order_release);
+    }
+
+    T*
+    front ()
+    {
+        size_t tail = m_tail.load (std::memory_order_relaxed);
+
+        if (tail == m_head.load (std::memory_order_acquire))
+            return nullptr;
+
+        return &m_slots[tail & m_mask];
+    }
+
+    void
+    pop ()
+    {
+        m_tail.store (m_tail.load (std::memory_order_relaxed) + 1,
+                      std::memory_order_release);
+    }
+
+    size_t
+    size () const
+    {
+        return m_head.load (std::memory_order_acquire)
+               - m_tail.load (std::memory_order_acquire);
+    }
+
+    size_t
+    capacity () const
+    {
+        return m_slots.size ();
+    }
+
+    std::vector<T>&
+    slots ()
+    {
+        return m_slots;
+    }
+
+  private:
+    static size_t
+    roundUpToPowerOfTwo (size_t value)
+    {
+        size_t result = 1;
+        while (result < value)
+            result <<= 1;
+        return result;
+    }
+
+    std::vector<T> m_slots;
+    size_t m_mask;
+
+    // keep producer and consumer indices on separate cache lines
+    char m_padding0[64];
+    std::atomic<size_t> m_head{ 0 };
+    char m_padding1[64 - sizeof (std::atomic<size_t>)];
+    std::atomic<size_t> m_tail{ 0 };
+};
+
+#endif /* IEC61850_SPSC_QUEUE_H */
@@ -217,6 +217,19 @@ addElementWithValue (Datapoint* dp, const std::string& name, const T value)
     return element;
 }
 
+// child positions are recorded while a PIVOT template is built
+static size_t
+lastChildIndex (Datapoint* dp)
+{
+    return dp->getData ().getDpVec ()->size () - 1;
+}
+
+static Datapoint*
+getChildAt (Datapoint* dp, size_t index)
+{
+    return (*dp->getData ().getDpVec ())[index];
+}
+
 const std::map<CDCTYPE, std::string> cdcToStrMap
     = { { SPS, "SpsTyp" }, { DPS, "DpsTyp" }, { BSC, "BscTyp" },
         { MV, "MvTyp" },   { SPC, "SpcTyp" }, { DPC, "DpcTyp" },
@@ -233,8 +246,14 @@ const std::map<PIVOTROOT, std::string> rootToStrMap
 
 IEC61850Client::IEC61850Client (IEC61850* iec61850,
                                 IEC61850ClientConfig* iec61850_client_config)
-    : m_config (iec61850_client_config), m_iec61850 (iec61850)
+    : m_config (iec61850_client_config), m_iec61850 (iec61850),
+      m_commandTracker (COMMAND_TRACKER_TICK, getMonotonicTimeInMs ())
 {
+    for (auto& def : m_config->ExchangeDefinition ())
+    {
+        def.pivotTemplate = createPivotTemplate (def);
+        def.converter = cdcConverter (def.cdcType);
+    }
 }
 
 IEC61850Client::~IEC61850Client () { stop (); }
@@ -249,12 +268,20 @@ IEC61850Client::stop ()
 
     m_started = false;
 
+    connectionStateChanged ();
+
     if (m_monitoringThread != nullptr)
     {
         m_monitoringThread->join ();
         delete m_monitoringThread;
         m_monitoringThread = nullptr;
     }
+
+    if (m_conversionPool != nullptr)
+    {
+        delete m_conversionPool;
+        m_conversionPool = nullptr;
+    }
 }
 
 int
@@ -462,15 +489,14 @@ PivotTimestamp::PivotTimestamp (Datapoint* timestampData)
 
 PivotTimestamp::PivotTimestamp (uint64_t ms)
 {
-    auto timeval32 = (uint32_t)(ms / 1000LL);
+    uint32_t timeval32 = EncodeSecondSinceEpoch (ms);
 
     m_valueArray[0] = (timeval32 / 0x1000000 & 0xff);
     m_valueArray[1] = (timeval32 / 0x10000 & 0xff);
     m_valueArray[2] = (timeval32 / 0x100 & 0xff);
     m_valueArray[3] = (timeval32 & 0xff);
 
-    uint32_t remainder = (ms % 1000LL);
-    uint32_t fractionOfSecond = remainder * 16777 + ((remainder * 216) / 1000);
+    uint32_t fractionOfSecond = EncodeFractionOfSecond (ms);
 
     m_valueArray[4] = ((fractionOfSecond >> 16) & 0xff);
     m_valueArray[5] = ((fractionOfSecond >> 8) & 0xff);
@@ -480,15 +506,14 @@ PivotTimestamp::PivotTimestamp (uint64_t ms)
 void
 PivotTimestamp::setTimeInMs (uint64_t ms)
 {
-    auto timeval32 = (uint32_t)(ms / 1000LL);
+    uint32_t timeval32 = EncodeSecondSinceEpoch (ms);
 
     m_valueArray[0] = (timeval32 / 0x1000000 & 0xff);
     m_valueArray[1] = (timeval32 / 0x10000 & 0xff);
     m_valueArray[2] = (timeval32 / 0x100 & 0xff);
     m_valueArray[3] = (timeval32 & 0xff);
 
-    uint32_t remainder = (ms % 1000LL);
-    uint32_t fractionOfSecond = remainder * 16777 + ((remainder * 216) / 1000);
+    uint32_t fractionOfSecond = EncodeFractionOfSecond (ms);
 
     m_valueArray[4] = ((fractionOfSecond >> 16) & 0xff);
     m_valueArray[5] = ((fractionOfSecond >> 8) & 0xff);
@@ -550,6 +575,12 @@ IEC61850Client::start ()
     if (m_started)
         return;
 
+    if (m_config->getConversionWorkers () > 0)
+    {
+        m_conversionPool = new IEC61850ConversionPool (
+            this, m_config->getConversionWorkers ());
+    }
+
     prepareConnections ();
     m_started = true;
     m_monitoringThread
@@ -588,13 +619,50 @@ IEC61850Client::updateConnectionStatus (ConnectionStatus newState)
 }
 
 void
-IEC61850Client::_monitoringThread ()
+IEC61850Client::connectionStateChanged ()
+{
+    m_signalMonitoringThread ();
+}
+
+void
+IEC61850Client::m_signalMonitoringThread ()
+{
+    {
+        std::lock_guard<std::mutex> lock (m_connectionEventLock);
+        m_connectionEventPending = true;
+    }
+    m_connectionEvent.notify_one ();
+}
+
+void
+IEC61850Client::m_waitForConnectionEvent (uint64_t deadline)
 {
-    uint64_t qualityUpdateTimeout = 500; /* 500 ms */
-    uint64_t qualityUpdateTimer = 0;
-    bool qualityUpdated = false;
-    bool firstConnected = false;
+    std::unique_lock<std::mutex> lock (m_connectionEventLock);
+
+    auto signalled = [this] { return m_connectionEventPending; };
+
+    if (deadline == UINT64_MAX)
+    {
+        m_connectionEvent.wait (lock, signalled);
+    }
+    else
+    {
+        uint64_t currentTime = Hal_getTimeInMs ();
+
+        if (deadline > currentTime)
+        {
+            m_connectionEvent.wait_for (
+                lock, std::chrono::milliseconds (deadline - currentTime),
+                signalled);
+        }
+    }
+
+    m_connectionEventPending = false;
+}
 
+void
+IEC61850Client::_monitoringThread ()
+{
     if (m_started)
     {
         std::lock_guard<std::mutex> lock (m_activeConnectionMtx);
@@ -606,61 +674,81 @@ IEC61850Client::_monitoringThread ()
 
     updateConnectionStatus (ConnectionStatus::NOT_CONNECTED);
 
-    uint64_t backupConnectionStartTime
-        = Hal_getTimeInMs () + BACKUP_CONNECTION_TIMEOUT;
+    size_t candidate = 0;
+
+    // end of the running connection attempt, 0 when there is none
+    uint64_t connectDeadline = 0;
 
     while (m_started)
     {
-        std::lock_guard<std::mutex> lock (m_activeConnectionMtx);
+        uint64_t deadline = UINT64_MAX;
 
-        if (m_active_connection == nullptr
-            || m_active_connection->Disconnected ())
         {
-            bool foundOpenConnections = false;
-            for (auto clientConnection : *m_connections)
-            {
-                backupConnectionStartTime
-                    = Hal_getTimeInMs () + BACKUP_CONNECTION_TIMEOUT;
-
-                foundOpenConnections = true;
-
-                clientConnection->Connect ();
-
-                m_active_connection = clientConnection;
+            std::lock_guard<std::mutex> lock (m_activeConnectionMtx);
 
-                Iec61850Utility::log_debug ("Trying connection %s:%d",
-                                            clientConnection->IP ().c_str (),
-                                            clientConnection->Port ());
-
-                auto start = std::chrono::high_resolution_clock::now ();
-                auto timeout = std::chrono::milliseconds (
-                    m_config->backupConnectionTimeout ());
-
-                while (!clientConnection->Connected ())
+            if (connectDeadline != 0)
+            {
+                if (m_active_connection->Connected ())
+                {
+                    connectDeadline = 0;
+                }
+                else if (Hal_getTimeInMs () > connectDeadline)
+                {
+                    m_active_connection->Disconnect ();
+                    m_active_connection = nullptr;
+                    connectDeadline = 0;
+                    candidate++;
+                }
+                else
                 {
-                    auto now = std::chrono::high_resolution_clock::now ();
-                    if (now - start > timeout)
-                    {
-                        clientConnection->Disconnect ();
-                        m_active_connection = nullptr;
-                        break;
-                    }
-                    Thread_sleep (10);
+                    deadline = connectDeadline;
                 }
+            }
+            else if (m_active_connection != nullptr
+                     && m_active_connection->Disconnected ())
+            {
+                m_active_connection = nullptr;
+                candidate = 0;
+            }
 
-                if (m_active_connection)
+            if (m_active_connection == nullptr && !m_connections->empty ())
+            {
+                if (candidate >= m_connections->size ())
                 {
-                    break;
+                    // every connection failed, start over after a pause
+                    candidate = 0;
+                    deadline = Hal_getTimeInMs () + CONNECTION_RETRY_DELAY;
+                }
+                else
+                {
+                    IEC61850ClientConnection* clientConnection
+                        = m_connections->at (candidate);
+
+                    clientConnection->Connect ();
+
+                    m_active_connection = clientConnection;
+                    connectDeadline = Hal_getTimeInMs ()
+                                      + m_config->backupConnectionTimeout ();
+                    deadline = connectDeadline;
+
+                    Iec61850Utility::log_debug (
+                        "Trying connection %s:%d",
+                        clientConnection->IP ().c_str (),
+                        clientConnection->Port ());
                 }
             }
         }
-        else
+
+        // expire sent commands while there are any
+        if (m_commandTracker.scheduled () > 0)
         {
-            backupConnectionStartTime
-                = Hal_getTimeInMs () + BACKUP_CONNECTION_TIMEOUT;
+            deadline = std::min<uint64_t> (
+                deadline, Hal_getTimeInMs () + COMMAND_TRACKER_TICK);
         }
 
-        Thread_sleep (100);
+        m_waitForConnectionEvent (deadline);
+
+        m_expireCommands ();
     }
 
     for (auto& clientConnection : *m_connections)
@@ -689,96 +777,247 @@ IEC61850Client::sendData (const std::vector<Datapoint*>& datapoints,
 }
 
 void
-IEC61850Client::handleAllValues ()
+IEC61850Client::handleAllValues (const std::shared_ptr<PollingGroup>& group)
 {
+    if (m_config->getPollingMode () == POLLING_BATCHED)
+    {
+        handleAllValuesBatched (group);
+        return;
+    }
+
+    if (m_config->getPollingMode () == POLLING_PIPELINED)
+    {
+        if (!m_active_connection)
+        {
+            Iec61850Utility::log_error ("No active connection");
+            return;
+        }
+        m_active_connection->pollPipelined (group.get ());
+        return;
+    }
+
     std::vector<std::string> labels;
     std::vector<Datapoint*> datapoints;
 
-    for (const auto& pair : m_config->polledDatapoints ())
+    for (const auto& pair : group->polledDatapoints)
     {
-        const std::shared_ptr<DataExchangeDefinition> def = pair.second;
-
-        CDCTYPE typeId = def->cdcType;
+        DataExchangeDefinition* def = pair.second;
 
-        labels.push_back (def->label);
         FunctionalConstraint fc = def->cdcType == MV || def->cdcType == APC
                                       ? IEC61850_FC_MX
                                       : IEC61850_FC_ST;
 
-        m_handleMonitoringData (def->objRef, datapoints, def->label, typeId,
-                                nullptr, "", fc, 0);
+        m_handleMonitoringData (def, datapoints, labels, nullptr, "", fc, 0,
+                                true);
     }
     sendData (datapoints, labels);
 }
 
 void
-IEC61850Client::handleValue (std::string objRef, MmsValue* mmsValue,
-                             uint64_t timestamp)
+IEC61850Client::handleAllValuesBatched (
+    const std::shared_ptr<PollingGroup>& group)
+{
+    if (!m_active_connection)
+    {
+        Iec61850Utility::log_error ("No active connection");
+        return;
+    }
+
+    for (const PollBatch* batch : m_active_connection->pollBatches ())
+    {
+        if (batch->group != group.get ())
+            continue;
+
+        std::vector<std::string> labels;
+        std::vector<Datapoint*> datapoints;
+
+        IedClientError error;
+        MmsValue* values = m_active_connection->readPollBatch (&error, batch);
+
+        if (!values)
+        {
+            logIedClientError (error, "Read poll batch " + batch->domainId);
+            continue;
+        }
+
+        bool isArray = MmsValue_getType (values) == MMS_ARRAY;
+        int item = 0;
+
+        for (size_t i = 0; i < batch->definitions.size (); i++)
+        {
+            DataExchangeDefinition* def
+                = batch->definitions[i];
+            int itemCount = batch->itemCounts[i];
+            std::string attribute;
+            MmsValue* minimalValue = nullptr;
+
+            MmsValue* value
+                = isArray ? MmsValue_getElement (values, item) : values;
+
+            // move the value, q and t of a minimal read into a list of
+            // their own, laid out as the definition's minimal elements
+            if (itemCount > 0 && isArray)
+            {
+                minimalValue = MmsValue_createEmptyArray (itemCount);
+                for (int j = 0; j < itemCount; j++)
+                {
+                    MmsValue_setElement (minimalValue, j,
+                                         MmsValue_getElement (values,
+                                                              item + j));
+                    MmsValue_setElement (values, item + j, nullptr);
+                }
+                value = minimalValue;
+                attribute = MINIMAL_READ_ATTRIBUTE;
+            }
+
+            item += std::max (itemCount, 1);
+
+            if (IEC61850ClientConnection::hasDataAccessError (value))
+            {
+                Iec61850Utility::log_error (
+                    "Read of %s failed with data access error %d",
+                    def->objRef.c_str (),
+                    value && !minimalValue ? MmsValue_getDataAccessError (value)
+                                           : -1);
+                if (minimalValue)
+                    MmsValue_delete (minimalValue);
+                continue;
+            }
+
+            if (m_conversionPool)
+            {
+                m_conversionPool->submit (
+                    { def, minimalValue ? minimalValue : MmsValue_clone (value),
+                      attribute, batch->fc, 0, true });
+                if (!isArray)
+                    break;
+                continue;
+            }
+
+            m_handleMonitoringData (def, datapoints, labels, value, attribute,
+                                    batch->fc, 0, true);
+
+            if (minimalValue)
+                MmsValue_delete (minimalValue);
+
+            if (!isArray)
+                break;
+        }
+
+        MmsValue_delete (values);
+
+        sendData (datapoints, labels);
+    }
+}
+
+void
+IEC61850Client::handlePolledValue (
+    DataExchangeDefinition* def, MmsValue* value,
+    const std::string& attribute, FunctionalConstraint fc)
+{
+    if (m_conversionPool)
+    {
+        m_conversionPool->submit (
+            { def, MmsValue_clone (value), attribute, fc, 0, true });
+        return;
+    }
+
+    convertAndSend (def, value, attribute, fc, 0, true);
+}
+
+void
+IEC61850Client::convertAndSend (
+    DataExchangeDefinition* def, MmsValue* value,
+    const std::string& attribute, FunctionalConstraint fc, uint64_t timestamp,
+    bool polled)
 {
     std::vector<std::string> labels;
     std::vector<Datapoint*> datapoints;
 
-    Iec61850Utility::log_debug ("Handle value %s", objRef.c_str ());
+    m_handleMonitoringData (def, datapoints, labels, value, attribute, fc,
+                            timestamp, polled);
+
+    if (datapoints.empty ())
+        return;
+
+    Iec61850Utility::log_debug ("Send %s",
+                                datapoints[0]->toJSONProperty ().c_str ());
+    sendData (datapoints, labels);
+}
+
+void
+IEC61850Client::drainConversions ()
+{
+    if (m_conversionPool)
+        m_conversionPool->drain ();
+}
 
-    size_t secondDotPos = objRef.find ('.', objRef.find ('.') + 1);
-    size_t bracketPos = objRef.find ('[');
+bool
+IEC61850Client::parseDataSetEntry (std::string entryName, std::string& objRef,
+                                   std::string& attribute,
+                                   FunctionalConstraint& fc)
+{
+    size_t secondDotPos = entryName.find ('.', entryName.find ('.') + 1);
+    size_t bracketPos = entryName.find ('[');
 
     if (bracketPos == std::string::npos)
     {
         Iec61850Utility::log_error (
-            "String parsing failed in handleValue for objRef: %s",
-            objRef.c_str ());
-        return;
+            "String parsing failed for dataset entry: %s", entryName.c_str ());
+        return false;
     }
 
-    std::string extracted;
-    std::string fcString;
-    FunctionalConstraint fcValue = IEC61850_FC_NONE;
+    attribute.clear ();
 
     if (secondDotPos != std::string::npos)
     {
-        extracted
-            = objRef.substr (secondDotPos + 1, bracketPos - secondDotPos - 1);
+        attribute = entryName.substr (secondDotPos + 1,
+                                      bracketPos - secondDotPos - 1);
     }
 
-    fcString
-        = objRef.substr (bracketPos + 1, objRef.find (']') - bracketPos - 1);
-    fcValue = stringToFunctionalConstraint (fcString);
+    std::string fcString = entryName.substr (
+        bracketPos + 1, entryName.find (']') - bracketPos - 1);
+    fc = stringToFunctionalConstraint (fcString);
+
     if (secondDotPos != std::string::npos)
     {
-        objRef.erase (secondDotPos);
+        entryName.erase (secondDotPos);
     }
     else
     {
-        objRef.erase (bracketPos);
+        entryName.erase (bracketPos);
     }
 
-    const std::shared_ptr<DataExchangeDefinition> def
-        = m_config->getExchangeDefinitionByObjRef (objRef);
+    objRef = entryName;
 
-    if (!def)
+    return true;
+}
+
+void
+IEC61850Client::handleValue (DataExchangeDefinition* def,
+                             MmsValue* mmsValue, const std::string& attribute,
+                             FunctionalConstraint fc, uint64_t timestamp)
+{
+    Iec61850Utility::log_debug ("Handle value %s", def->objRef.c_str ());
+
+    if (m_conversionPool)
     {
-        Iec61850Utility::log_debug ("No exchange definition found for %s",
-                                    objRef.c_str ());
+        m_conversionPool->submit ({ def, MmsValue_clone (mmsValue), attribute,
+                                    fc, timestamp, false });
         return;
     }
 
-    CDCTYPE typeId = def->cdcType;
-
-    labels.push_back (def->label);
-
-    m_handleMonitoringData (def->objRef, datapoints, def->label, typeId,
-                            mmsValue, extracted, fcValue, timestamp);
-    Iec61850Utility::log_debug ("Send %s",
-                                datapoints[0]->toJSONProperty ().c_str ());
-    sendData (datapoints, labels);
+    convertAndSend (def, mmsValue, attribute, fc, timestamp, false);
 }
 
 void
-IEC61850Client::m_handleMonitoringData (
-    const std::string& objRef, std::vector<Datapoint*>& datapoints,
-    const std::string& label, CDCTYPE type, MmsValue* mmsVal,
-    const std::string& attribute, FunctionalConstraint fc, uint64_t timestamp)
+IEC61850Client::m_handleMonitoringData (DataExchangeDefinition* def,
+                                        std::vector<Datapoint*>& datapoints,
+                                        std::vector<std::string>& labels,
+                                        MmsValue* mmsVal,
+                                        const std::string& attribute,
+                                        FunctionalConstraint fc,
+                                        uint64_t timestamp, bool polled)
 {
     if (!m_active_connection)
     {
@@ -787,314 +1026,674 @@ IEC61850Client::m_handleMonitoringData (
     }
 
     IedClientError error;
-    MmsValue* mmsvalue
-        = mmsVal
-              ? mmsVal
-              : m_active_connection->readValue (&error, objRef.c_str (), fc);
+    MmsValue* mmsvalue = mmsVal;
+    std::string readAttribute = attribute;
 
-    if (!mmsvalue)
+    if (!mmsvalue && m_config->getMinimalReads ()
+        && !def->minimalItems.empty ())
     {
-        logIedClientError (error, "Get MmsValue " + objRef);
-        return;
+        mmsvalue = m_active_connection->readMinimal (&error, def, fc);
+        readAttribute = MINIMAL_READ_ATTRIBUTE;
+
+        if (mmsvalue
+            && IEC61850ClientConnection::hasDataAccessError (mmsvalue))
+        {
+            Iec61850Utility::log_error ("Minimal read of %s failed",
+                                        def->objRef.c_str ());
+            MmsValue_delete (mmsvalue);
+            return;
+        }
+    }
+    else if (!mmsvalue)
+    {
+        mmsvalue = m_active_connection->readValue (&error,
+                                                   def->objRef.c_str (), fc);
     }
 
-    auto def = m_config->getExchangeDefinitionByObjRef (objRef);
-    if (!def || !def->spec)
+    if (!mmsvalue)
     {
-        Iec61850Utility::log_error ("Invalid definition/spec for %s",
-                                    objRef.c_str ());
-        cleanUpMmsValue (mmsVal, mmsvalue);
+        logIedClientError (error, "Get MmsValue " + def->objRef);
         return;
     }
 
-    Quality quality = extractQuality (mmsvalue, def->spec, attribute);
-    uint64_t ts;
+    // every label of the object reference gets a reading of its own
+    for (DataExchangeDefinition* target = def; target;
+         target = target->nextSameObjRef)
+    {
+        if (!target->spec || !target->pivotTemplate || !target->converter)
+        {
+            Iec61850Utility::log_error ("Invalid definition/spec for %s",
+                                        target->label.c_str ());
+            continue;
+        }
 
-    if (!mmsVal)
-        ts = extractTimestamp (mmsvalue, def->spec, attribute);
-    else
-        ts = timestamp;
+        if (polled && m_config->getChangeOnly ()
+            && !m_polledValueChanged (target, mmsvalue, readAttribute))
+            continue;
 
-    if (!processDatapoint (type, datapoints, label, objRef, mmsvalue,
-                           def->spec, quality, ts, attribute))
-    {
-        Iec61850Utility::log_error ("Error processing datapoint %s",
-                                    objRef.c_str ());
+        Quality quality = extractQuality (mmsvalue, *target, readAttribute);
+        uint64_t ts;
+
+        if (!mmsVal || polled)
+            ts = extractTimestamp (mmsvalue, *target, readAttribute);
+        else
+            ts = timestamp;
+
+        Datapoint* pivotDp = target->converter (*target, mmsvalue,
+                                                readAttribute, quality, ts);
+        if (pivotDp)
+        {
+            datapoints.push_back (pivotDp);
+            labels.push_back (target->label);
+        }
+        else
+        {
+            Iec61850Utility::log_error ("Error processing datapoint %s",
+                                        target->objRef.c_str ());
+        }
     }
 
     cleanUpMmsValue (mmsVal, mmsvalue);
 }
 
-Quality
-IEC61850Client::extractQuality (MmsValue* mmsvalue,
-                                MmsVariableSpecification* varSpec,
-                                const std::string& attribute)
+static MmsValue*
+getElementByIndex (MmsValue* mmsvalue, int index)
 {
-    MmsValue const* qualityMms
-        = MmsValue_getSubElement (mmsvalue, varSpec, (char*)"q");
-    return (!qualityMms && attribute != "q")
-               ? QUALITY_VALIDITY_GOOD
-               : Quality_fromMmsValue (qualityMms);
+    return index < 0 ? nullptr : MmsValue_getElement (mmsvalue, index);
 }
 
-uint64_t
-IEC61850Client::extractTimestamp (MmsValue* mmsvalue,
-                                  MmsVariableSpecification* varSpec,
-                                  const std::string& attribute)
+// indices into a complete data object or a minimal value, q, t read
+static const DataElementIndices*
+elementIndices (const DataExchangeDefinition& def, const std::string& attribute)
 {
-    MmsValue const* timestampMms
-        = MmsValue_getSubElement (mmsvalue, varSpec, (char*)"t");
-    return (!timestampMms && attribute != "t")
-               ? PivotTimestamp::GetCurrentTimeInMs ()
-               : MmsValue_getUtcTimeInMs (timestampMms);
+    if (attribute.empty ())
+        return &def.elements;
+    if (attribute == MINIMAL_READ_ATTRIBUTE)
+        return &def.minimalElements;
+    return nullptr;
 }
 
-bool
-IEC61850Client::processDatapoint (
-    CDCTYPE type, std::vector<Datapoint*>& datapoints,
-    const std::string& label, const std::string& objRef, MmsValue* mmsvalue,
-    MmsVariableSpecification* varSpec, Quality quality, uint64_t timestamp,
-    const std::string& attribute)
+// only value, q and t of a data object make a polled value change, other
+// attributes of its functional constraint are not compared
+static bool
+polledElementsEqual (const DataElementIndices* elements, MmsValue* last,
+                     MmsValue* value)
 {
-    switch (type)
+    if (!elements)
+        return MmsValue_equals (last, value);
+
+    for (int index : { elements->value, elements->q, elements->t })
     {
-    case SPC:
-    case SPS:
-        return processBooleanType (datapoints, label, objRef, mmsvalue,
-                                   varSpec, quality, timestamp, attribute,
-                                   "stVal");
-    case BSC:
-        return processBSCType (datapoints, label, objRef, mmsvalue, varSpec,
-                               quality, timestamp, attribute, "valWTr");
-    case MV:
-        return processAnalogType (datapoints, label, objRef, mmsvalue, varSpec,
-                                  quality, timestamp, attribute, "mag");
-    case APC:
-        return processAnalogType (datapoints, label, objRef, mmsvalue, varSpec,
-                                  quality, timestamp, attribute, "mxVal");
-    case ENS:
-    case INS:
-    case DPS:
-    case DPC:
-    case INC:
-        return processIntegerType (datapoints, label, objRef, mmsvalue,
-                                   varSpec, quality, timestamp, attribute,
-                                   "stVal");
-    default:
-        return false;
-    }
-}
+        if (index < 0)
+            continue;
 
-void
-IEC61850Client::cleanUpMmsValue (MmsValue* originalMmsVal,
-                                 MmsValue* usedMmsVal)
-{
-    if (usedMmsVal && !originalMmsVal)
-        MmsValue_delete (usedMmsVal);
-}
+        MmsValue const* lastElement = getElementByIndex (last, index);
+        MmsValue const* element = getElementByIndex (value, index);
 
-bool
-IEC61850Client::processBooleanType (
-    std::vector<Datapoint*>& datapoints, const std::string& label,
-    const std::string& objRef, MmsValue* mmsvalue,
-    MmsVariableSpecification* varSpec, Quality quality, uint64_t timestamp,
-    const std::string& attribute, const char* elementName)
-{
-    MmsValue const* element
-        = MmsValue_getSubElement (mmsvalue, varSpec, (char*)elementName);
-    if (!element)
-    {
-        if (attribute == elementName)
-        {
-            element = mmsvalue;
-        }
-        else
-        {
-            Iec61850Utility::log_error ("No %s found %s", elementName,
-                                        objRef.c_str ());
+        if (!lastElement || !element
+            || !MmsValue_equals (lastElement, element))
             return false;
-        }
     }
-    bool value = MmsValue_getBoolean (element);
-    datapoints.push_back (
-        m_createDatapoint (label, objRef, (long)value, quality, timestamp));
+
     return true;
 }
 
 bool
-IEC61850Client::processBSCType (std::vector<Datapoint*>& datapoints,
-                                const std::string& label,
-                                const std::string& objRef, MmsValue* mmsvalue,
-                                MmsVariableSpecification* varSpec,
-                                Quality quality, uint64_t timestamp,
-                                const std::string& attribute,
-                                const char* elementName)
-{
-    MmsValue* element
-        = MmsValue_getSubElement (mmsvalue, varSpec, (char*)elementName);
-    if (!element)
-    {
-        if (attribute == elementName)
-        {
-            element = mmsvalue;
-        }
-        else
-        {
-            Iec61850Utility::log_error ("No %s found %s", elementName,
-                                        objRef.c_str ());
+IEC61850Client::m_polledValueChanged (DataExchangeDefinition* def,
+                                      MmsValue* value,
+                                      const std::string& attribute)
+{
+    uint64_t now = Hal_getTimeInMs ();
+
+    if (def->lastPolledValue
+        && polledElementsEqual (elementIndices (*def, attribute),
+                                def->lastPolledValue, value))
+    {
+        long forcedRefresh = m_config->getForcedRefresh ();
+        if (forcedRefresh == 0
+            || now - def->lastForwardTime < (uint64_t)forcedRefresh)
             return false;
-        }
     }
-
-    varSpec = MmsVariableSpecification_getChildSpecificationByName (
-        varSpec, elementName, nullptr);
-    MmsValue const* posVal
-        = MmsValue_getSubElement (element, varSpec, (char*)"posVal");
-    MmsValue const* transInd
-        = MmsValue_getSubElement (element, varSpec, (char*)"transInd");
-
-    if (!posVal || !transInd)
+    else if (!def->lastPolledValue
+             || !MmsValue_update (def->lastPolledValue, value))
     {
-        Iec61850Utility::log_error ("Missing components in %s %s", elementName,
-                                    objRef.c_str ());
-        return false;
+        if (def->lastPolledValue)
+            MmsValue_delete (def->lastPolledValue);
+        def->lastPolledValue = MmsValue_clone (value);
     }
 
-    long value = MmsValue_toInt32 (posVal);
-    bool transIndVal = MmsValue_getBoolean (transInd);
-    long combinedValue = (value << 1) | (long)transIndVal;
-    datapoints.push_back (
-        m_createDatapoint (label, objRef, combinedValue, quality, timestamp));
+    def->lastForwardTime = now;
+
     return true;
 }
 
-bool
-IEC61850Client::processAnalogType (
-    std::vector<Datapoint*>& datapoints, const std::string& label,
-    const std::string& objRef, MmsValue* mmsvalue,
-    MmsVariableSpecification* varSpec, Quality quality, uint64_t timestamp,
-    const std::string& attribute, const char* elementName)
+Quality
+IEC61850Client::extractQuality (MmsValue* mmsvalue,
+                                const DataExchangeDefinition& def,
+                                const std::string& attribute)
 {
-    MmsValue* element
-        = MmsValue_getSubElement (mmsvalue, varSpec, (char*)elementName);
-    if (!element)
-    {
-        if (attribute == elementName)
-        {
-            element = mmsvalue;
-        }
-        else
-        {
-            Iec61850Utility::log_error ("No %s found %s", elementName,
-                                        objRef.c_str ());
-            return false;
-        }
-    }
+    const DataElementIndices* elements = elementIndices (def, attribute);
+    MmsValue const* qualityMms
+        = elements           ? getElementByIndex (mmsvalue, elements->q)
+          : attribute == "q" ? mmsvalue
+                             : nullptr;
+    return !qualityMms ? QUALITY_VALIDITY_GOOD
+                       : Quality_fromMmsValue (qualityMms);
+}
+
+uint64_t
+IEC61850Client::extractTimestamp (MmsValue* mmsvalue,
+                                  const DataExchangeDefinition& def,
+                                  const std::string& attribute)
+{
+    const DataElementIndices* elements = elementIndices (def, attribute);
+    MmsValue const* timestampMms
+        = elements           ? getElementByIndex (mmsvalue, elements->t)
+          : attribute == "t" ? mmsvalue
+                             : nullptr;
+    return !timestampMms ? PivotTimestamp::GetCurrentTimeInMs ()
+                         : MmsValue_getUtcTimeInMs (timestampMms);
+}
 
-    varSpec = MmsVariableSpecification_getChildSpecificationByName (
-        varSpec, elementName, nullptr);
-    MmsValue* f = MmsValue_getSubElement (element, varSpec, (char*)"f");
+static MmsValue*
+getValueElement (const DataExchangeDefinition& def, MmsValue* mmsvalue,
+                 const std::string& attribute, const char* elementName)
+{
+    // a complete data object or a minimal read is indexed, a single
+    // attribute is the value
+    const DataElementIndices* elements = elementIndices (def, attribute);
 
-    if (f)
+    if (elements)
     {
-        double value = MmsValue_toFloat (f);
-        datapoints.push_back (
-            m_createDatapoint (label, objRef, value, quality, timestamp));
-        return true;
+        MmsValue* element = getElementByIndex (mmsvalue, elements->value);
+        if (element)
+            return element;
     }
-
-    MmsValue* i = MmsValue_getSubElement (element, varSpec, (char*)"i");
-    if (i)
+    else if (attribute == elementName)
     {
-        long value = MmsValue_toInt32 (i);
-        datapoints.push_back (
-            m_createDatapoint (label, objRef, value, quality, timestamp));
-        return true;
+        return mmsvalue;
     }
 
-    Iec61850Utility::log_error ("No analog value found %s", objRef.c_str ());
-    return false;
+    Iec61850Utility::log_error ("No %s found %s", elementName,
+                                def.objRef.c_str ());
+    return nullptr;
 }
 
-bool
-IEC61850Client::processIntegerType (
-    std::vector<Datapoint*>& datapoints, const std::string& label,
-    const std::string& objRef, MmsValue* mmsvalue,
-    MmsVariableSpecification* varSpec, Quality quality, uint64_t timestamp,
-    const std::string& attribute, const char* elementName)
+/* Per-CDC decoding of the MMS value component and encoding of the PIVOT
+ * value datapoints. Each CDC provides its value component name, the value
+ * type, a prepare () function adding the value node to the PIVOT template
+ * and typed extract () and encode () functions. encode () sets the value in
+ * the copy of the node added by prepare (). */
+template <CDCTYPE cdc> struct CdcTraits;
+
+struct BooleanStatusTraits
+{
+    typedef long ValueType;
+
+    static constexpr const char*
+    valueElement ()
+    {
+        return "stVal";
+    }
+
+    static bool
+    extract (const DataExchangeDefinition&, MmsValue* element,
+             ValueType& value)
+    {
+        value = MmsValue_getBoolean (element);
+        return true;
+    }
+
+    static void
+    prepare (Datapoint* cdcDp)
+    {
+        addElementWithValue (cdcDp, "stVal", 0L);
+    }
+
+    static void
+    encode (Datapoint* valueDp, ValueType value)
+    {
+        valueDp->getData ().setValue (value);
+    }
+};
+
+struct IntegerStatusTraits
 {
-    MmsValue const* element
-        = MmsValue_getSubElement (mmsvalue, varSpec, (char*)elementName);
-    if (!element)
+    typedef long ValueType;
+
+    static constexpr const char*
+    valueElement ()
+    {
+        return "stVal";
+    }
+
+    static bool
+    extract (const DataExchangeDefinition&, MmsValue* element,
+             ValueType& value)
+    {
+        value = MmsValue_toInt32 (element);
+        return true;
+    }
+
+    static void
+    prepare (Datapoint* cdcDp)
+    {
+        addElementWithValue (cdcDp, "stVal", 0L);
+    }
+
+    static void
+    encode (Datapoint* valueDp, ValueType value)
+    {
+        valueDp->getData ().setValue (value);
+    }
+};
+
+struct DoublePointStatusTraits : IntegerStatusTraits
+{
+    static constexpr const char*
+    stateName (ValueType value)
+    {
+        return value == 0   ? "intermediate-state"
+               : value == 1 ? "off"
+               : value == 2 ? "on"
+               : value == 3 ? "bad-state"
+                            : "";
+    }
+
+    static void
+    prepare (Datapoint* cdcDp)
     {
-        if (attribute == elementName)
+        addElementWithValue (cdcDp, "stVal", std::string ());
+    }
+
+    static void
+    encode (Datapoint* valueDp, ValueType value)
+    {
+        valueDp->getData () = DatapointValue ((std::string)stateName (value));
+    }
+};
+
+struct AnalogueValue
+{
+    bool isFloat;
+    double f;
+    long i;
+};
+
+struct AnalogueTraits
+{
+    typedef AnalogueValue ValueType;
+
+    static bool
+    extract (const DataExchangeDefinition& def, MmsValue* element,
+             ValueType& value)
+    {
+        MmsValue* f = getElementByIndex (element, def.elements.valueF);
+        if (f)
         {
-            element = mmsvalue;
+            value.isFloat = true;
+            value.f = MmsValue_toFloat (f);
+            return true;
         }
+
+        MmsValue* i = getElementByIndex (element, def.elements.valueI);
+        if (i)
+        {
+            value.isFloat = false;
+            value.i = MmsValue_toInt32 (i);
+            return true;
+        }
+
+        Iec61850Utility::log_error ("No analog value found %s",
+                                    def.objRef.c_str ());
+        return false;
+    }
+
+    // f or i is only known with the value
+    static void
+    encode (Datapoint* valueDp, const ValueType& value)
+    {
+        if (value.isFloat)
+            addElementWithValue (valueDp, "f", value.f);
         else
+            addElementWithValue (valueDp, "i", value.i);
+    }
+};
+
+template <> struct CdcTraits<SPS> : BooleanStatusTraits
+{
+};
+
+template <> struct CdcTraits<SPC> : BooleanStatusTraits
+{
+};
+
+template <> struct CdcTraits<INS> : IntegerStatusTraits
+{
+};
+
+template <> struct CdcTraits<ENS> : IntegerStatusTraits
+{
+};
+
+template <> struct CdcTraits<INC> : IntegerStatusTraits
+{
+};
+
+template <> struct CdcTraits<DPS> : DoublePointStatusTraits
+{
+};
+
+template <> struct CdcTraits<DPC> : DoublePointStatusTraits
+{
+};
+
+template <> struct CdcTraits<MV> : AnalogueTraits
+{
+    static constexpr const char*
+    valueElement ()
+    {
+        return "mag";
+    }
+
+    static void
+    prepare (Datapoint* cdcDp)
+    {
+        addElement (cdcDp, "mag");
+    }
+};
+
+template <> struct CdcTraits<APC> : AnalogueTraits
+{
+    static constexpr const char*
+    valueElement ()
+    {
+        return "mxVal";
+    }
+
+    static void
+    prepare (Datapoint* cdcDp)
+    {
+        addElement (cdcDp, "mxVal");
+    }
+};
+
+template <> struct CdcTraits<BSC>
+{
+    typedef long ValueType;
+
+    static constexpr const char*
+    valueElement ()
+    {
+        return "valWTr";
+    }
+
+    static bool
+    extract (const DataExchangeDefinition& def, MmsValue* element,
+             ValueType& value)
+    {
+        MmsValue const* posVal
+            = getElementByIndex (element, def.elements.posVal);
+        MmsValue const* transInd
+            = getElementByIndex (element, def.elements.transInd);
+
+        if (!posVal || !transInd)
         {
-            Iec61850Utility::log_error ("No %s found %s", elementName,
-                                        objRef.c_str ());
+            Iec61850Utility::log_error ("Missing components in %s %s",
+                                        valueElement (), def.objRef.c_str ());
             return false;
         }
+
+        value = ((long)MmsValue_toInt32 (posVal) << 1)
+                | (long)MmsValue_getBoolean (transInd);
+        return true;
     }
-    long value = MmsValue_toInt32 (element);
-    datapoints.push_back (
-        m_createDatapoint (label, objRef, value, quality, timestamp));
-    return true;
-}
 
-template <class T>
+    static void
+    prepare (Datapoint* cdcDp)
+    {
+        Datapoint* valWtrDp = addElement (cdcDp, "valWtr");
+        addElementWithValue (valWtrDp, "posVal", 0L);
+        addElementWithValue (valWtrDp, "transInd", 0L);
+    }
+
+    static void
+    encode (Datapoint* valueDp, ValueType value)
+    {
+        getChild (valueDp, "posVal")->getData ().setValue (value >> 1);
+        getChild (valueDp, "transInd")->getData ().setValue (value & 1);
+    }
+};
+
+template <CDCTYPE cdc>
 Datapoint*
-IEC61850Client::m_createDatapoint (const std::string& label,
-                                   const std::string& objRef, T value,
-                                   Quality quality, uint64_t timestamp)
+IEC61850Client::m_convertCdc (const DataExchangeDefinition& def,
+                              MmsValue* mmsvalue,
+                              const std::string& attribute, Quality quality,
+                              uint64_t timestamp)
 {
-    auto def = m_config->getExchangeDefinitionByLabel (label);
+    typedef CdcTraits<cdc> Traits;
 
-    Datapoint* pivotDp = createDp ("PIVOT");
+    MmsValue* element = getValueElement (def, mmsvalue, attribute,
+                                         Traits::valueElement ());
+    typename Traits::ValueType value;
 
-    auto root = (PIVOTROOT)getRootFromCDC (def->cdcType);
+    if (!element || !Traits::extract (def, element, value))
+        return nullptr;
 
-    Datapoint* rootDp = addElement (pivotDp, rootToStrMap.at (root));
-    addElementWithValue (rootDp, "ComingFrom", (std::string) "iec61850");
-    addElementWithValue (rootDp, "Identifier", (std::string)def->label);
-    Datapoint* cdcDp = addElement (rootDp, cdcToStrMap.at (def->cdcType));
+    const PivotTemplate& pivotTemplate = *def.pivotTemplate;
 
-    addValueDp (cdcDp, def->cdcType, value);
-    addQualityDp (cdcDp, quality);
-    addTimestampDp (cdcDp, timestamp);
+    // the reading owns its tree, so the template is copied as a whole and
+    // only the value, quality and timestamp nodes of the copy are set
+    auto pivotDp = new Datapoint (*pivotTemplate.pivot);
+
+    Datapoint* cdcDp = getChildAt (
+        getChildAt (pivotDp, pivotTemplate.root), pivotTemplate.cdc);
+
+    Traits::encode (getChildAt (cdcDp, pivotTemplate.value), value);
+    setQualityDp (pivotTemplate, getChildAt (cdcDp, pivotTemplate.q),
+                  quality);
+    setTimestampDp (pivotTemplate, getChildAt (cdcDp, pivotTemplate.t),
+                    timestamp);
 
     return pivotDp;
 }
 
-void
-IEC61850Client::addQualityDp (Datapoint* cdcDp, Quality quality) const
+template <CDCTYPE cdc>
+static void
+prepareValue (Datapoint* cdcDp)
 {
-    Datapoint* qualityDp = addElement (cdcDp, "q");
-    addElementWithValue (qualityDp, "test",
-                         (long)Quality_isFlagSet (&quality, QUALITY_TEST));
+    CdcTraits<cdc>::prepare (cdcDp);
+}
 
-    Validity val = Quality_getValidity (&quality);
-    if (val == QUALITY_VALIDITY_GOOD)
+static bool
+addValueTemplate (CDCTYPE type, Datapoint* cdcDp)
+{
+    switch (type)
     {
-        addElementWithValue (qualityDp, "Validity", (std::string) "good");
+    case SPS:
+        prepareValue<SPS> (cdcDp);
+        return true;
+    case DPS:
+        prepareValue<DPS> (cdcDp);
+        return true;
+    case MV:
+        prepareValue<MV> (cdcDp);
+        return true;
+    case INS:
+        prepareValue<INS> (cdcDp);
+        return true;
+    case ENS:
+        prepareValue<ENS> (cdcDp);
+        return true;
+    case SPC:
+        prepareValue<SPC> (cdcDp);
+        return true;
+    case DPC:
+        prepareValue<DPC> (cdcDp);
+        return true;
+    case APC:
+        prepareValue<APC> (cdcDp);
+        return true;
+    case INC:
+        prepareValue<INC> (cdcDp);
+        return true;
+    case BSC:
+        prepareValue<BSC> (cdcDp);
+        return true;
+    default:
+        return false;
     }
-    else if (val == QUALITY_VALIDITY_INVALID)
+}
+
+CdcConverter
+IEC61850Client::cdcConverter (CDCTYPE type)
+{
+    switch (type)
     {
-        addElementWithValue (qualityDp, "Validity", (std::string) "invalid");
+    case SPS:
+        return &IEC61850Client::m_convertCdc<SPS>;
+    case DPS:
+        return &IEC61850Client::m_convertCdc<DPS>;
+    case MV:
+        return &IEC61850Client::m_convertCdc<MV>;
+    case INS:
+        return &IEC61850Client::m_convertCdc<INS>;
+    case ENS:
+        return &IEC61850Client::m_convertCdc<ENS>;
+    case SPC:
+        return &IEC61850Client::m_convertCdc<SPC>;
+    case DPC:
+        return &IEC61850Client::m_convertCdc<DPC>;
+    case APC:
+        return &IEC61850Client::m_convertCdc<APC>;
+    case INC:
+        return &IEC61850Client::m_convertCdc<INC>;
+    case BSC:
+        return &IEC61850Client::m_convertCdc<BSC>;
+    default:
+        return nullptr;
     }
-    else if (val == QUALITY_VALIDITY_RESERVED)
+}
+
+const char*
+IEC61850Client::valueElementName (CDCTYPE type)
+{
+    switch (type)
     {
-        addElementWithValue (qualityDp, "Validity", (std::string) "reserved");
+    case SPS:
+        return CdcTraits<SPS>::valueElement ();
+    case DPS:
+        return CdcTraits<DPS>::valueElement ();
+    case MV:
+        return CdcTraits<MV>::valueElement ();
+    case INS:
+        return CdcTraits<INS>::valueElement ();
+    case ENS:
+        return CdcTraits<ENS>::valueElement ();
+    case SPC:
+        return CdcTraits<SPC>::valueElement ();
+    case DPC:
+        return CdcTraits<DPC>::valueElement ();
+    case APC:
+        return CdcTraits<APC>::valueElement ();
+    case INC:
+        return CdcTraits<INC>::valueElement ();
+    case BSC:
+        return CdcTraits<BSC>::valueElement ();
+    default:
+        return nullptr;
     }
-    else if (val == QUALITY_VALIDITY_QUESTIONABLE)
+}
+
+void
+IEC61850Client::cleanUpMmsValue (MmsValue* originalMmsVal,
+                                 MmsValue* usedMmsVal)
+{
+    if (usedMmsVal && !originalMmsVal)
+        MmsValue_delete (usedMmsVal);
+}
+
+std::shared_ptr<PivotTemplate>
+IEC61850Client::createPivotTemplate (const DataExchangeDefinition& def)
+{
+    if (rootMap.find (def.cdcType) == rootMap.end ())
+        return nullptr;
+
+    std::shared_ptr<PivotTemplate> pivotTemplate (new PivotTemplate ());
+
+    Datapoint* pivotDp = createDp ("PIVOT");
+    pivotTemplate->pivot.reset (pivotDp);
+
+    auto root = (PIVOTROOT)getRootFromCDC (def.cdcType);
+
+    Datapoint* rootDp = addElement (pivotDp, rootToStrMap.at (root));
+    pivotTemplate->root = lastChildIndex (pivotDp);
+    addElementWithValue (rootDp, "ComingFrom", (std::string) "iec61850");
+    addElementWithValue (rootDp, "Identifier", (std::string)def.label);
+
+    Datapoint* cdcDp = addElement (rootDp, cdcToStrMap.at (def.cdcType));
+    pivotTemplate->cdc = lastChildIndex (rootDp);
+
+    if (!addValueTemplate (def.cdcType, cdcDp))
+        return nullptr;
+    pivotTemplate->value = lastChildIndex (cdcDp);
+
+    Datapoint* qualityDp = addElement (cdcDp, "q");
+    pivotTemplate->q = lastChildIndex (cdcDp);
+    addElementWithValue (qualityDp, "test", 0L);
+    pivotTemplate->test = lastChildIndex (qualityDp);
+    addElementWithValue (qualityDp, "Validity", (std::string) "good");
+    pivotTemplate->validity = lastChildIndex (qualityDp);
+    addElement (qualityDp, "DetailQuality");
+    pivotTemplate->detailQuality = lastChildIndex (qualityDp);
+
+    Datapoint* timestampDp = addElement (cdcDp, "t");
+    pivotTemplate->t = lastChildIndex (cdcDp);
+    addElementWithValue (timestampDp, "SecondSinceEpoch", 0L);
+    pivotTemplate->secondSinceEpoch = lastChildIndex (timestampDp);
+    addElementWithValue (timestampDp, "FractionOfSecond", 0L);
+    pivotTemplate->fractionOfSecond = lastChildIndex (timestampDp);
+
+    return pivotTemplate;
+}
+
+static const char*
+validityName (Validity validity)
+{
+    switch (validity)
+    {
+    case QUALITY_VALIDITY_GOOD:
+        return "good";
+    case QUALITY_VALIDITY_INVALID:
+        return "invalid";
+    case QUALITY_VALIDITY_RESERVED:
+        return "reserved";
+    case QUALITY_VALIDITY_QUESTIONABLE:
+        return "questionable";
+    default:
+        return nullptr;
+    }
+}
+
+void
+IEC61850Client::setQualityDp (const PivotTemplate& pivotTemplate,
+                              Datapoint* qualityDp, Quality quality)
+{
+    getChildAt (qualityDp, pivotTemplate.test)
+        ->getData ()
+        .setValue ((long)Quality_isFlagSet (&quality, QUALITY_TEST));
+
+    // the template holds a good validity
+    Validity val = Quality_getValidity (&quality);
+    if (val != QUALITY_VALIDITY_GOOD && validityName (val))
     {
-        addElementWithValue (qualityDp, "Validity",
-                             (std::string) "questionable");
+        getChildAt (qualityDp, pivotTemplate.validity)->getData ()
+            = DatapointValue ((std::string)validityName (val));
     }
 
-    Datapoint* detailQualityDp = addElement (qualityDp, "DetailQuality");
+    Datapoint* detailQualityDp
+        = getChildAt (qualityDp, pivotTemplate.detailQuality);
 
     if (Quality_isFlagSet (&quality, QUALITY_DETAIL_OVERFLOW))
     {
@@ -1121,73 +1720,16 @@ IEC61850Client::addQualityDp (Datapoint* cdcDp, Quality quality) const
 }
 
 void
-IEC61850Client::addTimestampDp (Datapoint* cdcDp, uint64_t timestampMs) const
+IEC61850Client::setTimestampDp (const PivotTemplate& pivotTemplate,
+                                Datapoint* timestampDp, uint64_t timestampMs)
 {
-    std::unique_ptr<PivotTimestamp> ts (new PivotTimestamp (timestampMs));
-    Datapoint* tsDp = addElement (cdcDp, "t");
-    addElementWithValue (tsDp, "SecondSinceEpoch",
-                         (long)ts->SecondSinceEpoch ());
-    addElementWithValue (tsDp, "FractionOfSecond",
-                         (long)ts->FractionOfSecond ());
-}
-
-template <class T>
-void
-IEC61850Client::addValueDp (Datapoint* cdcDp, CDCTYPE type, T value) const
-{
-    switch (type)
-    {
-    case SPC:
-    case INC:
-    case ENS:
-    case INS:
-    case SPS: {
-        addElementWithValue (cdcDp, "stVal", (long)value);
-        break;
-    }
-    case DPC:
-    case DPS: {
-        auto valueInt = (long)value;
-        std::string stVal;
-        if (valueInt == 0)
-            stVal = "intermediate-state";
-        else if (valueInt == 1)
-            stVal = "off";
-        else if (valueInt == 2)
-            stVal = "on";
-        else if (valueInt == 3)
-            stVal = "bad-state";
-        addElementWithValue (cdcDp, "stVal", (std::string)stVal);
-        break;
-    }
-    case APC:
-    case MV: {
-        Datapoint* magDp = addElement (cdcDp, type == MV ? "mag" : "mxVal");
-        if (std::is_same<T, double>::value)
-        {
-            addElementWithValue (magDp, "f", (double)value);
-        }
-        else if (std::is_same<T, long>::value)
-        {
-            addElementWithValue (magDp, "i", (long)value);
-        }
-        else
-        {
-            Iec61850Utility::log_error ("Invalid mag data type");
-        }
-        break;
-    }
-    case BSC: {
-        Datapoint* valWtrDp = addElement (cdcDp, "valWtr");
-        addElementWithValue (valWtrDp, "posVal", (long)value >> 1);
-        addElementWithValue (valWtrDp, "transInd", (long)value & 1);
-        break;
-    }
-    default: {
-        Iec61850Utility::log_error ("Invalid cdcType %d", type);
-        break;
-    }
-    }
+    getChildAt (timestampDp, pivotTemplate.secondSinceEpoch)
+        ->getData ()
+        .setValue ((long)(int32_t)PivotTimestamp::EncodeSecondSinceEpoch (
+            timestampMs));
+    getChildAt (timestampDp, pivotTemplate.fractionOfSecond)
+        ->getData ()
+        .setValue ((long)PivotTimestamp::EncodeFractionOfSecond (timestampMs));
 }
 
 bool
@@ -1205,7 +1747,7 @@ IEC61850Client::handleOperation (Datapoint* operation)
 
     std::string id = getValueStr (identifierDp);
 
-    const std::shared_ptr<DataExchangeDefinition> def
+    const DataExchangeDefinition* def
         = m_config->getExchangeDefinitionByPivotId (id);
 
     if (!def)
@@ -1266,34 +1808,95 @@ IEC61850Client::handleOperation (Datapoint* operation)
     }
     else
     {
-        res = m_active_connection->operate (objRef, value);
-        m_outstandingCommands[label] = operation;
+        // tracked before the command is issued, its ActCon may come first.
+        // The timeout only starts when the connection sends it.
+        uint64_t commandId = m_commandTracker.add (label, operation);
+
+        res = m_active_connection->operate (objRef, value, commandId);
+
+        if (!res)
+            m_commandTracker.remove (commandId);
     }
 
     return res;
 }
 
+bool
+IEC61850Client::commandDispatched (uint64_t commandId)
+{
+    // a command that is no longer tracked has already been answered
+    if (!m_commandTracker.schedule (commandId, m_config->getCommandTimeout (),
+                                    getMonotonicTimeInMs ()))
+        return false;
+
+    m_signalMonitoringThread ();
+
+    return true;
+}
+
 void
-IEC61850Client::sendCommandAck (const std::string& label, ControlModel mode,
-                                bool terminated)
+IEC61850Client::commandIgnored (uint64_t commandId)
 {
-    if (m_outstandingCommands.empty ())
-    {
-        Iec61850Utility::log_error ("No outstanding commands");
-        return;
-    }
+    m_commandTracker.remove (commandId);
+}
 
-    auto it = m_outstandingCommands.find (label);
-    if (it == m_outstandingCommands.end ())
+void
+IEC61850Client::sendCommandAck (uint64_t commandId, const std::string& label,
+                                ControlModel mode, bool terminated)
+{
+    bool complete = terminated || mode == CONTROL_MODEL_SBO_NORMAL
+                    || mode == CONTROL_MODEL_DIRECT_NORMAL;
+
+    std::shared_ptr<Datapoint> operation
+        = m_commandTracker.acknowledge (commandId, complete);
+
+    if (!operation)
     {
         Iec61850Utility::log_error (
             "No outstanding command with label %s found", label.c_str ());
         return;
     }
 
+    m_sendCommandAck (label, operation.get (), terminated, false);
+}
+
+void
+IEC61850Client::commandFailed (uint64_t commandId, const std::string& label,
+                               bool terminated)
+{
+    std::shared_ptr<Datapoint> operation
+        = m_commandTracker.acknowledge (commandId, true);
+
+    if (!operation)
+        return;
+
+    m_sendCommandAck (label, operation.get (), terminated, true);
+}
+
+void
+IEC61850Client::m_expireCommands ()
+{
+    std::vector<std::unique_ptr<TrackedCommand> > expired;
+
+    m_commandTracker.expire (getMonotonicTimeInMs (), expired);
+
+    for (const auto& command : expired)
+    {
+        Iec61850Utility::log_warn ("Command %s timed out",
+                                   command->label.c_str ());
+        m_sendCommandAck (command->label, command->operation.get (),
+                          command->confirmed, true);
+    }
+}
+
+void
+IEC61850Client::m_sendCommandAck (const std::string& label,
+                                  Datapoint* operation, bool terminated,
+                                  bool negative)
+{
     Datapoint* pivotRoot = createDp ("PIVOT");
     Datapoint* command
-        = addElementWithValue (pivotRoot, "GTIC", it->second->getData ());
+        = addElementWithValue (pivotRoot, "GTIC", operation->getData ());
     int cot = terminated ? 10 : 7;
     Datapoint* causeDp = nullptr;
     causeDp = getChild (command, "Cause");
@@ -1314,18 +1917,22 @@ IEC61850Client::sendCommandAck (const std::string& label, ControlModel mode,
         addElementWithValue (causeDp, "stVal", (long)cot);
     }
 
+    if (negative)
+    {
+        Datapoint* confirmationDp = getChild (command, "Confirmation");
+        if (!confirmationDp)
+            confirmationDp = addElement (command, "Confirmation");
+
+        Datapoint* stVal = getChild (confirmationDp, "stVal");
+        if (stVal)
+            stVal->getData ().setValue ((long)1);
+        else
+            addElementWithValue (confirmationDp, "stVal", (long)1);
+    }
+
     std::vector<Datapoint*> datapoints;
     std::vector<std::string> labels;
     labels.push_back (label);
     datapoints.push_back (pivotRoot);
     sendData (datapoints, labels);
-
-    if (terminated
-        || (!terminated
-            && (mode == CONTROL_MODEL_SBO_NORMAL
-                || mode == CONTROL_MODEL_DIRECT_NORMAL)))
-    {
-        delete m_outstandingCommands[label];
-        m_outstandingCommands.erase (label);
-    }
 }
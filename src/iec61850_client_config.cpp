@@ -16,6 +16,23 @@
 #define JSON_DATASET_REF "dataset_ref"
 #define JSON_DATASET_ENTRIES "entries"
 #define JSON_POLLING_INTERVAL "polling_interval"
+#define JSON_POLLING_MODE "polling_mode"
+#define JSON_MAX_OUTSTANDING_READS "max_outstanding_reads"
+#define JSON_ASSOCIATIONS "associations"
+#define JSON_MAX_CONCURRENT_COMMANDS "max_concurrent_commands"
+#define JSON_COMMAND_TIMEOUT "command_timeout"
+#define JSON_MINIMAL_READS "minimal_reads"
+#define JSON_POLLING_GROUPS "polling_groups"
+#define JSON_CHANGE_ONLY "change_only"
+#define JSON_REPORT_QUEUE_SIZE "report_queue_size"
+#define JSON_CONVERSION_WORKERS "conversion_workers"
+#define JSON_FORCED_REFRESH "forced_refresh"
+#define JSON_MODEL_CACHE "model_cache"
+#define JSON_AUTO_REPORTING "auto_reporting"
+#define JSON_MAX_DATASET_ENTRIES "max_dataset_entries"
+#define JSON_POLLING_GROUP_NAME "name"
+#define JSON_POLLING_GROUP_INTERVAL "interval"
+#define JSON_POLLING_GROUP_DATAPOINTS "datapoints"
 #define JSON_REPORT_SUBSCRIPTIONS "report_subscriptions"
 #define JSON_RCB_REF "rcb_ref"
 #define JSON_TRGOPS "trgops"
@@ -41,6 +58,11 @@ static const std::unordered_map<std::string, int> trgOptions
         { "gi", TRG_OPT_GI },
         { "transient", TRG_OPT_TRANSIENT } };
 
+static const std::unordered_map<std::string, POLLINGMODE> pollingModes
+    = { { "sequential", POLLING_SEQUENTIAL },
+        { "batched", POLLING_BATCHED },
+        { "pipelined", POLLING_PIPELINED } };
+
 static const std::unordered_map<std::string, CDCTYPE> cdcMap
     = { { "SpsTyp", SPS }, { "DpsTyp", DPS }, { "BscTyp", BSC },
         { "MvTyp", MV },   { "SpcTyp", SPC }, { "DpcTyp", DPC },
@@ -59,27 +81,100 @@ IEC61850ClientConfig::getCdcTypeFromString (const std::string& cdc)
     return -1; // LCOV_EXCL_LINE
 }
 
-std::shared_ptr<DataExchangeDefinition>
-IEC61850ClientConfig::getExchangeDefinitionByLabel (const std::string& label)
+const uint32_t DefinitionIndex::EMPTY_SLOT;
+
+size_t
+DefinitionIndex::m_findSlot (
+    const std::vector<DataExchangeDefinition>& definitions,
+    const std::string& key) const
 {
-    auto it = m_exchangeDefinitions.find (label);
-    if (it != m_exchangeDefinitions.end ())
+    size_t mask = m_slots.size () - 1;
+    size_t slot = std::hash<std::string> () (key) & mask;
+
+    while (m_slots[slot] != EMPTY_SLOT
+           && definitions[m_slots[slot]].*m_key != key)
     {
-        return it->second;
+        slot = (slot + 1) & mask;
     }
-    return nullptr;
+
+    return slot;
 }
 
-std::shared_ptr<DataExchangeDefinition>
-IEC61850ClientConfig::getExchangeDefinitionByPivotId (
-    const std::string& pivotId)
+void
+DefinitionIndex::m_rehash (
+    const std::vector<DataExchangeDefinition>& definitions, size_t slotCount)
 {
-    auto it = m_exchangeDefinitionsPivotId.find (pivotId);
-    if (it != m_exchangeDefinitionsPivotId.end ())
+    std::vector<uint32_t> oldSlots;
+    oldSlots.swap (m_slots);
+    m_slots.assign (slotCount, EMPTY_SLOT);
+
+    for (uint32_t handle : oldSlots)
     {
-        return it->second;
+        if (handle != EMPTY_SLOT)
+            m_slots[m_findSlot (definitions, definitions[handle].*m_key)]
+                = handle;
     }
-    return nullptr;
+}
+
+bool
+DefinitionIndex::insert (const std::vector<DataExchangeDefinition>& definitions,
+                         uint32_t handle)
+{
+    // keep the load factor at or below one half
+    if ((m_used + 1) * 2 > m_slots.size ())
+        m_rehash (definitions, std::max<size_t> (16, m_slots.size () * 2));
+
+    size_t slot = m_findSlot (definitions, definitions[handle].*m_key);
+
+    // the first definition with a key wins
+    if (m_slots[slot] != EMPTY_SLOT)
+        return false;
+
+    m_slots[slot] = handle;
+    m_used++;
+
+    return true;
+}
+
+DataExchangeDefinition*
+DefinitionIndex::find (std::vector<DataExchangeDefinition>& definitions,
+                       const std::string& key) const
+{
+    if (m_slots.empty ())
+        return nullptr;
+
+    uint32_t handle = m_slots[m_findSlot (definitions, key)];
+
+    return handle == EMPTY_SLOT ? nullptr : &definitions[handle];
+}
+
+void
+DefinitionIndex::clear ()
+{
+    m_slots.clear ();
+    m_used = 0;
+}
+
+DataExchangeDefinition*
+IEC61850ClientConfig::getExchangeDefinition (uint32_t handle)
+{
+    if (handle >= m_exchangeDefinitions.size ())
+        return nullptr;
+
+    return &m_exchangeDefinitions[handle];
+}
+
+DataExchangeDefinition*
+IEC61850ClientConfig::getExchangeDefinitionByLabel (const std::string& label)
+{
+    return m_exchangeDefinitionsLabel.find (m_exchangeDefinitions, label);
+}
+
+DataExchangeDefinition*
+IEC61850ClientConfig::getExchangeDefinitionByPivotId (
+    const std::string& pivotId)
+{
+    return m_exchangeDefinitionsPivotId.find (m_exchangeDefinitions, pivotId);
 }
 
 bool
@@ -97,12 +192,41 @@ IEC61850ClientConfig::isValidIPAddress (const std::string& addrStr)
 void
 IEC61850ClientConfig::deleteExchangeDefinitions ()
 {
+    for (auto& def : m_exchangeDefinitions)
+    {
+        if (def.lastPolledValue)
+        {
+            MmsValue_delete (def.lastPolledValue);
+            def.lastPolledValue = nullptr;
+        }
+        def.spec = nullptr;
+    }
+
+    m_specCache.clear ();
+    m_specSource.clear ();
+
     m_exchangeDefinitions.clear ();
+    m_exchangeDefinitionsLabel.clear ();
     m_exchangeDefinitionsObjRef.clear ();
     m_exchangeDefinitionsPivotId.clear ();
     m_polledDatapoints.clear ();
 }
 
+void
+IEC61850ClientConfig::resetVariableSpecs (const std::string& source)
+{
+    for (auto& def : m_exchangeDefinitions)
+    {
+        def.spec = nullptr;
+        def.elements = DataElementIndices ();
+        def.minimalItems.clear ();
+        def.minimalElements = DataElementIndices ();
+    }
+
+    m_specCache.clear ();
+    m_specSource = source;
+}
+
 IEC61850ClientConfig::~IEC61850ClientConfig ()
 {
     deleteExchangeDefinitions ();
@@ -238,6 +362,165 @@ IEC61850ClientConfig::importProtocolConfig (const std::string& protocolConfig)
         pollingInterval = intVal;
     }
 
+    if (applicationLayer.HasMember (JSON_POLLING_MODE))
+    {
+        if (!applicationLayer[JSON_POLLING_MODE].IsString ())
+        {
+            Iec61850Utility::log_error ("polling_mode has invalid data type");
+            return;
+        }
+        auto it = pollingModes.find (
+            applicationLayer[JSON_POLLING_MODE].GetString ());
+        if (it == pollingModes.end ())
+        {
+            Iec61850Utility::log_error ("Unknown polling_mode %s",
+                                        applicationLayer[JSON_POLLING_MODE]
+                                            .GetString ());
+            return;
+        }
+        m_pollingMode = it->second;
+    }
+
+    if (applicationLayer.HasMember (JSON_MAX_OUTSTANDING_READS))
+    {
+        if (!applicationLayer[JSON_MAX_OUTSTANDING_READS].IsInt ()
+            || applicationLayer[JSON_MAX_OUTSTANDING_READS].GetInt () <= 0)
+        {
+            Iec61850Utility::log_error (
+                "max_outstanding_reads must be a positive integer");
+            return;
+        }
+        m_maxOutstandingReads
+            = applicationLayer[JSON_MAX_OUTSTANDING_READS].GetInt ();
+    }
+
+    if (applicationLayer.HasMember (JSON_ASSOCIATIONS))
+    {
+        if (!applicationLayer[JSON_ASSOCIATIONS].IsInt ()
+            || applicationLayer[JSON_ASSOCIATIONS].GetInt () <= 0)
+        {
+            Iec61850Utility::log_error (
+                "associations must be a positive integer");
+            return;
+        }
+        m_associations = applicationLayer[JSON_ASSOCIATIONS].GetInt ();
+    }
+
+    if (applicationLayer.HasMember (JSON_MAX_CONCURRENT_COMMANDS))
+    {
+        if (!applicationLayer[JSON_MAX_CONCURRENT_COMMANDS].IsInt ()
+            || applicationLayer[JSON_MAX_CONCURRENT_COMMANDS].GetInt () <= 0)
+        {
+            Iec61850Utility::log_error (
+                "max_concurrent_commands must be a positive integer");
+            return;
+        }
+        m_maxConcurrentCommands
+            = applicationLayer[JSON_MAX_CONCURRENT_COMMANDS].GetInt ();
+    }
+
+    if (applicationLayer.HasMember (JSON_COMMAND_TIMEOUT))
+    {
+        if (!applicationLayer[JSON_COMMAND_TIMEOUT].IsInt ()
+            || applicationLayer[JSON_COMMAND_TIMEOUT].GetInt () <= 0)
+        {
+            Iec61850Utility::log_error (
+                "command_timeout must be a positive integer");
+            return;
+        }
+        m_commandTimeout = applicationLayer[JSON_COMMAND_TIMEOUT].GetInt ();
+    }
+
+    if (applicationLayer.HasMember (JSON_MINIMAL_READS))
+    {
+        if (!applicationLayer[JSON_MINIMAL_READS].IsBool ())
+        {
+            Iec61850Utility::log_error ("minimal_reads must be a boolean");
+            return;
+        }
+        m_minimalReads = applicationLayer[JSON_MINIMAL_READS].GetBool ();
+    }
+
+    if (applicationLayer.HasMember (JSON_CHANGE_ONLY))
+    {
+        if (!applicationLayer[JSON_CHANGE_ONLY].IsBool ())
+        {
+            Iec61850Utility::log_error ("change_only has invalid data type");
+            return;
+        }
+        m_changeOnly = applicationLayer[JSON_CHANGE_ONLY].GetBool ();
+    }
+
+    if (applicationLayer.HasMember (JSON_FORCED_REFRESH))
+    {
+        if (!applicationLayer[JSON_FORCED_REFRESH].IsInt ()
+            || applicationLayer[JSON_FORCED_REFRESH].GetInt () < 0)
+        {
+            Iec61850Utility::log_error (
+                "forced_refresh must be a positive integer");
+            return;
+        }
+        m_forcedRefresh = applicationLayer[JSON_FORCED_REFRESH].GetInt ();
+    }
+
+    if (applicationLayer.HasMember (JSON_REPORT_QUEUE_SIZE))
+    {
+        if (!applicationLayer[JSON_REPORT_QUEUE_SIZE].IsInt ()
+            || applicationLayer[JSON_REPORT_QUEUE_SIZE].GetInt () < 0)
+        {
+            Iec61850Utility::log_error (
+                "report_queue_size must be a positive integer");
+            return;
+        }
+        m_reportQueueSize = applicationLayer[JSON_REPORT_QUEUE_SIZE].GetInt ();
+    }
+
+    if (applicationLayer.HasMember (JSON_CONVERSION_WORKERS))
+    {
+        if (!applicationLayer[JSON_CONVERSION_WORKERS].IsInt ()
+            || applicationLayer[JSON_CONVERSION_WORKERS].GetInt () < 0)
+        {
+            Iec61850Utility::log_error (
+                "conversion_workers must be a positive integer");
+            return;
+        }
+        m_conversionWorkers
+            = applicationLayer[JSON_CONVERSION_WORKERS].GetInt ();
+    }
+
+    if (applicationLayer.HasMember (JSON_MODEL_CACHE))
+    {
+        if (!applicationLayer[JSON_MODEL_CACHE].IsString ())
+        {
+            Iec61850Utility::log_error ("model_cache must be a directory");
+            return;
+        }
+        m_modelCacheDir = applicationLayer[JSON_MODEL_CACHE].GetString ();
+    }
+
+    if (applicationLayer.HasMember (JSON_AUTO_REPORTING))
+    {
+        if (!applicationLayer[JSON_AUTO_REPORTING].IsBool ())
+        {
+            Iec61850Utility::log_error ("auto_reporting must be a boolean");
+            return;
+        }
+        m_autoReporting = applicationLayer[JSON_AUTO_REPORTING].GetBool ();
+    }
+
+    if (applicationLayer.HasMember (JSON_MAX_DATASET_ENTRIES))
+    {
+        if (!applicationLayer[JSON_MAX_DATASET_ENTRIES].IsInt ()
+            || applicationLayer[JSON_MAX_DATASET_ENTRIES].GetInt () <= 0)
+        {
+            Iec61850Utility::log_error (
+                "max_dataset_entries must be a positive integer");
+            return;
+        }
+        m_maxDatasetEntries
+            = applicationLayer[JSON_MAX_DATASET_ENTRIES].GetInt ();
+    }
+
     if (applicationLayer.HasMember (JSON_DATASETS)
         && applicationLayer[JSON_DATASETS].IsArray ())
     {
@@ -280,7 +563,7 @@ IEC61850ClientConfig::importProtocolConfig (const std::string& protocolConfig)
                             extractedObjRef.erase (bracketPos);
                         }
 
-                        const std::shared_ptr<DataExchangeDefinition> def
+                        const DataExchangeDefinition* def
                             = getExchangeDefinitionByObjRef (extractedObjRef);
 
                         if (def)
@@ -388,9 +671,105 @@ IEC61850ClientConfig::importProtocolConfig (const std::string& protocolConfig)
         }
     }
 
+    m_pollingGroups.clear ();
+
+    if (applicationLayer.HasMember (JSON_POLLING_GROUPS))
+    {
+        if (!applicationLayer[JSON_POLLING_GROUPS].IsArray ())
+        {
+            Iec61850Utility::log_error (
+                "polling_groups has invalid data type");
+            return;
+        }
+        importJsonPollingGroups (applicationLayer[JSON_POLLING_GROUPS]);
+    }
+
+    assignPollingGroups ();
+
     m_protocolConfigComplete = true;
 }
 
+void
+IEC61850ClientConfig::importJsonPollingGroups (
+    const rapidjson::Value& pollingGroups)
+{
+    for (const auto& groupVal : pollingGroups.GetArray ())
+    {
+        if (!groupVal.IsObject ()
+            || !groupVal.HasMember (JSON_POLLING_GROUP_NAME)
+            || !groupVal[JSON_POLLING_GROUP_NAME].IsString ())
+        {
+            Iec61850Utility::log_error ("Polling group without name -> ignore");
+            continue;
+        }
+
+        auto group = std::make_shared<PollingGroup> ();
+        group->name = groupVal[JSON_POLLING_GROUP_NAME].GetString ();
+
+        if (!groupVal.HasMember (JSON_POLLING_GROUP_INTERVAL)
+            || !groupVal[JSON_POLLING_GROUP_INTERVAL].IsInt ()
+            || groupVal[JSON_POLLING_GROUP_INTERVAL].GetInt () <= 0)
+        {
+            Iec61850Utility::log_error (
+                "Polling group %s has invalid interval -> ignore",
+                group->name.c_str ());
+            continue;
+        }
+        group->interval = groupVal[JSON_POLLING_GROUP_INTERVAL].GetInt ();
+
+        if (groupVal.HasMember (JSON_POLLING_GROUP_DATAPOINTS)
+            && groupVal[JSON_POLLING_GROUP_DATAPOINTS].IsArray ())
+        {
+            for (const auto& labelVal :
+                 groupVal[JSON_POLLING_GROUP_DATAPOINTS].GetArray ())
+            {
+                if (labelVal.IsString ())
+                    group->labels.push_back (labelVal.GetString ());
+            }
+        }
+
+        m_pollingGroups.push_back (group);
+    }
+}
+
+void
+IEC61850ClientConfig::assignPollingGroups ()
+{
+    std::unordered_map<std::string, std::shared_ptr<PollingGroup> >
+        groupByLabel;
+
+    for (const auto& group : m_pollingGroups)
+    {
+        group->polledDatapoints.clear ();
+        for (const auto& label : group->labels)
+        {
+            if (!groupByLabel.insert ({ label, group }).second)
+            {
+                Iec61850Utility::log_warn (
+                    "%s is already part of polling group %s -> ignored in %s",
+                    label.c_str (), groupByLabel[label]->name.c_str (),
+                    group->name.c_str ());
+            }
+        }
+    }
+
+    auto defaultGroup = std::make_shared<PollingGroup> ();
+    defaultGroup->name = "default";
+    defaultGroup->interval = pollingInterval;
+
+    for (const auto& entry : m_polledDatapoints)
+    {
+        auto it = groupByLabel.find (entry.second->label);
+        if (it != groupByLabel.end ())
+            it->second->polledDatapoints.insert (entry);
+        else
+            defaultGroup->polledDatapoints.insert (entry);
+    }
+
+    if (pollingInterval > 0 && !defaultGroup->polledDatapoints.empty ())
+        m_pollingGroups.push_back (defaultGroup);
+}
+
 void
 IEC61850ClientConfig::importJsonConnectionOsiConfig (
     const rapidjson::Value& connOsiConfig, RedGroup& iedConnectionParam)
@@ -680,6 +1059,10 @@ IEC61850ClientConfig::importExchangeConfig (const std::string& exchangeConfig)
 
     const Value& datapoints = exchangeData[JSON_DATAPOINTS];
 
+    // a datapoint yields at most one definition (its label is unique), so
+    // the table never reallocates and pointers into it stay valid
+    m_exchangeDefinitions.reserve (datapoints.Size ());
+
     for (const Value& datapoint : datapoints.GetArray ())
     {
         if (!datapoint.IsObject ())
@@ -758,9 +1141,7 @@ IEC61850ClientConfig::importExchangeConfig (const std::string& exchangeConfig)
 
             auto cdcType = static_cast<CDCTYPE> (typeId);
 
-            auto it = m_exchangeDefinitions.find (label);
-
-            if (it != m_exchangeDefinitions.end ())
+            if (getExchangeDefinitionByLabel (label))
             {
                 Iec61850Utility::log_warn ("DataExchangeDefinition with label "
                                            "%s already exists -> ignore",
@@ -768,30 +1149,54 @@ IEC61850ClientConfig::importExchangeConfig (const std::string& exchangeConfig)
                 continue;
             }
 
-            auto def = std::make_shared<DataExchangeDefinition> ();
+            // further labels of an object reference are read along with the
+            // first one, so they have to address the same data
+            DataExchangeDefinition* first
+                = getExchangeDefinitionByObjRef (objRef);
+
+            if (first
+                && (first->cdcType == MV || first->cdcType == APC)
+                       != (cdcType == MV || cdcType == APC))
+            {
+                Iec61850Utility::log_warn (
+                    "DataExchangeDefinition %s reads %s with another "
+                    "functional constraint than %s -> ignore",
+                    label.c_str (), objRef.c_str (), first->label.c_str ());
+                continue;
+            }
+
+            auto handle = (uint32_t)m_exchangeDefinitions.size ();
+
+            m_exchangeDefinitions.emplace_back ();
+            DataExchangeDefinition* def = &m_exchangeDefinitions.back ();
 
             def->objRef = objRef;
             def->cdcType = cdcType;
             def->label = label;
             def->id = pivot_id;
+            def->handle = handle;
+
+            m_exchangeDefinitionsLabel.insert (m_exchangeDefinitions, handle);
+            m_exchangeDefinitionsPivotId.insert (m_exchangeDefinitions,
+                                                 handle);
+            if (first)
+            {
+                while (first->nextSameObjRef)
+                    first = first->nextSameObjRef;
+                first->nextSameObjRef = def;
+                continue;
+            }
 
-            m_exchangeDefinitions.insert ({ label, def });
-            m_exchangeDefinitionsPivotId.insert ({ pivot_id, def });
-            m_exchangeDefinitionsObjRef.insert ({ objRef, def });
+            m_exchangeDefinitionsObjRef.insert (m_exchangeDefinitions, handle);
             m_polledDatapoints.insert ({ objRef, def });
         }
     }
 }
 
-std::shared_ptr<DataExchangeDefinition>
+DataExchangeDefinition*
 IEC61850ClientConfig::getExchangeDefinitionByObjRef (const std::string& objRef)
 {
-    auto it = m_exchangeDefinitionsObjRef.find (objRef);
-    if (it != m_exchangeDefinitionsObjRef.end ())
-    {
-        return it->second;
-    }
-    return nullptr;
+    return m_exchangeDefinitionsObjRef.find (m_exchangeDefinitions, objRef);
 }
 
 void
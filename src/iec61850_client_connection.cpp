@@ -1,15 +1,25 @@
 #include "iec61850_client_connection.hpp"
 #include "iec61850_client_config.hpp"
+#include "iec61850_report_planner.hpp"
 #include <algorithm>
+#include <chrono>
 #include <iec61850.hpp>
 #include <libiec61850/hal_thread.h>
 #include <libiec61850/iec61850_client.h>
 #include <libiec61850/mms_value.h>
 #include <map>
+#include <set>
 #include <string>
 #include <utils.h>
 #include <vector>
 
+#define DEFAULT_MAX_PDU_SIZE 65000
+#define POLL_BATCH_PDU_OVERHEAD 64
+#define POLL_BATCH_ITEM_OVERHEAD 12
+#define POLL_BATCH_DEFAULT_ITEM_SIZE 64
+#define POLL_SCHEDULER_TICK 50
+#define BRING_UP_TIMEOUT 10000
+
 IEC61850ClientConnection::IEC61850ClientConnection (
     IEC61850Client* client, IEC61850ClientConfig* config,
     const std::string& ip, const int tcpPort, bool tls,
@@ -17,9 +27,39 @@ IEC61850ClientConnection::IEC61850ClientConnection (
     : m_client (client), m_config (config), m_osiParameters (osiParameters),
       m_tcpPort (tcpPort), m_serverIp (ip), m_useTls (tls)
 {
+    if (m_config->getReportQueueSize () > 0)
+    {
+        m_reportQueue = new SpscQueue<QueuedReportValue> (
+            m_config->getReportQueueSize ());
+        for (auto& slot : m_reportQueue->slots ())
+        {
+            slot = { nullptr, nullptr, 0 };
+        }
+    }
+
+    if (!m_config->getModelCacheDir ().empty ())
+    {
+        m_modelCache = new IEC61850ModelCache (m_config->getModelCacheDir (),
+                                               m_serverIp, m_tcpPort);
+    }
 }
 
-IEC61850ClientConnection::~IEC61850ClientConnection () { Stop (); }
+IEC61850ClientConnection::~IEC61850ClientConnection ()
+{
+    Stop ();
+
+    if (m_reportQueue)
+    {
+        for (auto& slot : m_reportQueue->slots ())
+        {
+            if (slot.value)
+                MmsValue_delete (slot.value);
+        }
+        delete m_reportQueue;
+    }
+
+    delete m_modelCache;
+}
 
 static uint64_t
 getMonotonicTimeInMs ()
@@ -40,6 +80,15 @@ void
 IEC61850ClientConnection::commandTerminationHandler (
     void* parameter, ControlObjectClient connection)
 {
+    auto context = (CommandContext*)parameter;
+    IEC61850ClientConnection* con = context->connection;
+    ControlObjectStruct* cos;
+    uint64_t commandId;
+
+    // a late termination of a command that already timed out
+    if (!con->m_completeTermination (context, connection, cos, commandId))
+        return;
+
     LastApplError lastApplError
         = ControlObjectClient_getLastApplError (connection);
     if (lastApplError.error != CONTROL_ERROR_NO_ERROR)
@@ -48,17 +97,11 @@ IEC61850ClientConnection::commandTerminationHandler (
             lastApplError.addCause, lastApplError.error,
             std::string (ControlObjectClient_getObjectReference (connection)));
         Iec61850Utility::log_error ("Couldn't terminate command");
+        con->m_client->commandFailed (commandId, cos->label, true);
         return;
     }
 
-    auto connectionCosPair
-        = (std::pair<IEC61850ClientConnection*, ControlObjectStruct*>*)
-            parameter;
-    IEC61850ClientConnection* con = connectionCosPair->first;
-    ControlObjectStruct* cos = connectionCosPair->second;
-
-    cos->state = CONTROL_IDLE;
-    con->sendActTerm (cos);
+    con->sendActTerm (cos, commandId);
 }
 
 // LCOV_EXCL_START
@@ -175,10 +218,11 @@ IEC61850ClientConnection::logControlErrors (ControlAddCause addCause,
 // LCOV_EXCL_STOP
 
 void
-IEC61850ClientConnection::m_setOsiConnectionParameters ()
+IEC61850ClientConnection::m_setOsiConnectionParameters (
+    IedConnection connection)
 {
     MmsConnection mmsConnection
-        = IedConnection_getMmsConnection (m_connection);
+        = IedConnection_getMmsConnection (connection);
     IsoConnectionParameters libiecIsoParams
         = MmsConnection_getIsoConnectionParameters (mmsConnection);
     const OsiParameters& osiParams = *m_osiParameters;
@@ -208,77 +252,116 @@ IEC61850ClientConnection::m_setOsiConnectionParameters ()
         osiParams.remoteTSelector);
 }
 
-void
-IEC61850ClientConnection::m_configDatasets ()
+static bool
+dataSetDirectoryMatches (LinkedList dataSetDirectory,
+                         const std::vector<std::string>& entries)
 {
-    for (const auto& pair : m_config->getDatasets ())
+    LinkedList element = LinkedList_getNext (dataSetDirectory);
+
+    for (const auto& entry : entries)
     {
-        IedClientError error;
-        std::shared_ptr<Dataset> dataset = pair.second;
+        if (!element || entry != (char*)element->data)
+            return false;
 
-        if (dataset->dynamic)
-        {
-            bool createDataset = true;
+        element = LinkedList_getNext (element);
+    }
 
-            Iec61850Utility::log_debug ("Create new dataset %s",
-                                        dataset->datasetRef.c_str ());
+    return element == nullptr;
+}
+
+bool
+IEC61850ClientConnection::m_provisionDataset (const Dataset& dataset,
+                                              bool& created)
+{
+    IedClientError error;
+    bool createDataset = true;
 
-            bool isDeletable = false;
+    created = false;
 
-            LinkedList dsDir = IedConnection_getDataSetDirectory(m_connection, &error, dataset->datasetRef.c_str(), &isDeletable);
+    bool isDeletable = false;
 
-            if (error == IED_ERROR_OK)
-            {
-                if (isDeletable == false) {
-                    Iec61850Utility::log_error("Dataset %s already exists and cannot be deleted -> is static?", dataset->datasetRef.c_str());
-                    createDataset = false;
-                }
-                else {
-                    Iec61850Utility::log_info("Delete existing dataset %s", dataset->datasetRef.c_str());
+    LinkedList dsDir = IedConnection_getDataSetDirectory(m_connection, &error, dataset.datasetRef.c_str(), &isDeletable);
 
-                    if (IedConnection_deleteDataSet(m_connection, &error, dataset->datasetRef.c_str()) == false) {
-                        m_client->logIedClientError (error, "Delete Dataset");
-                        createDataset = false;
-                    }
-                }
+    if (error == IED_ERROR_OK)
+    {
+        if (dataSetDirectoryMatches (dsDir, dataset.entries)) {
+            Iec61850Utility::log_debug("Dataset %s is up to date", dataset.datasetRef.c_str());
+            createDataset = false;
+        }
+        else if (isDeletable == false) {
+            Iec61850Utility::log_error("Dataset %s already exists and cannot be deleted -> is static?", dataset.datasetRef.c_str());
+            LinkedList_destroy(dsDir);
+            return false;
+        }
+        else {
+            Iec61850Utility::log_info("Delete existing dataset %s", dataset.datasetRef.c_str());
 
+            if (IedConnection_deleteDataSet(m_connection, &error, dataset.datasetRef.c_str()) == false) {
+                m_client->logIedClientError (error, "Delete Dataset");
                 LinkedList_destroy(dsDir);
+                return false;
             }
+        }
 
-            if (createDataset)
-            {
-                LinkedList newDataSetEntries = LinkedList_create ();
+        LinkedList_destroy(dsDir);
+    }
 
-                if (newDataSetEntries == nullptr)
-                {
-                    continue;
-                }
+    if (!createDataset)
+        return true;
 
-                for (const auto& entry : dataset->entries)
-                {
-                    char* strCopy
-                        = static_cast<char*> (malloc (entry.length () + 1));
-                    if (strCopy != nullptr)
-                    {
-                        std::strcpy (strCopy, entry.c_str ());
-                        LinkedList_add (newDataSetEntries,
-                                        static_cast<void*> (strCopy));
-                    }
-                }
+    Iec61850Utility::log_debug ("Create new dataset %s",
+                                dataset.datasetRef.c_str ());
 
-                IedConnection_createDataSet (m_connection, &error,
-                                            dataset->datasetRef.c_str (),
-                                            newDataSetEntries);
+    LinkedList newDataSetEntries = LinkedList_create ();
 
-                if (error != IED_ERROR_OK)
-                {
-                    m_client->logIedClientError (error, "Create Dataset");
-                }
+    if (newDataSetEntries == nullptr)
+    {
+        return false;
+    }
 
-                LinkedList_destroyDeep (newDataSetEntries, free);
-            }
+    for (const auto& entry : dataset.entries)
+    {
+        char* strCopy = static_cast<char*> (malloc (entry.length () + 1));
+        if (strCopy != nullptr)
+        {
+            std::strcpy (strCopy, entry.c_str ());
+            LinkedList_add (newDataSetEntries, static_cast<void*> (strCopy));
         }
     }
+
+    IedConnection_createDataSet (m_connection, &error,
+                                dataset.datasetRef.c_str (),
+                                newDataSetEntries);
+
+    LinkedList_destroyDeep (newDataSetEntries, free);
+
+    if (error != IED_ERROR_OK)
+    {
+        m_client->logIedClientError (error, "Create Dataset");
+        return false;
+    }
+
+    created = true;
+
+    return true;
+}
+
+int
+IEC61850ClientConnection::m_configDatasets ()
+{
+    int createdDatasets = 0;
+
+    for (const auto& pair : m_config->getDatasets ())
+    {
+        std::shared_ptr<Dataset> dataset = pair.second;
+        bool created = false;
+
+        if (dataset->dynamic && m_provisionDataset (*dataset, created)
+            && created)
+            createdDatasets++;
+    }
+
+    return createdDatasets;
 }
 
 void
@@ -293,9 +376,8 @@ void
 IEC61850ClientConnection::reportCallbackFunction (void* parameter,
                                                   ClientReport report)
 {
-    auto pair = (std::pair<IEC61850ClientConnection*, LinkedList>*)parameter;
-    IEC61850ClientConnection* con = pair->first;
-    LinkedList dataSetDirectory = pair->second;
+    auto table = static_cast<ReportDispatchTable*> (parameter);
+    IEC61850ClientConnection* con = table->connection;
 
     MmsValue const* dataSetValues = ClientReport_getDataSetValues (report);
 
@@ -313,31 +395,172 @@ IEC61850ClientConnection::reportCallbackFunction (void* parameter,
                                     (unsigned int)(unixTime / 1000));
     }
 
-    if (!dataSetDirectory)
+    if (!dataSetValues)
         return;
 
-    for (int i = 0; i < LinkedList_size (dataSetDirectory); i++)
+    if (con->m_firstReportPending.exchange (false))
+    {
+        con->m_timeToFirstReport
+            = getMonotonicTimeInMs () - con->m_associatedTime;
+        Iec61850Utility::log_info ("First report %ld ms after connect",
+                                   (long)con->m_timeToFirstReport);
+    }
+
+    int entryCount = (int)table->entries.size ();
+
+    for (int i = 0; i < entryCount; i++)
     {
+        const ReportEntry& entry = table->entries[i];
+
+        if (!entry.def)
+            continue;
+
         ReasonForInclusion reason
             = ClientReport_getReasonForInclusion (report, i);
 
         if (reason == IEC61850_REASON_NOT_INCLUDED)
             continue;
 
-        LinkedList entry = LinkedList_get (dataSetDirectory, i);
-
-        auto* entryName = (char*)entry->data;
-        if (!dataSetValues)
-            continue;
         MmsValue* value = MmsValue_getElement (dataSetValues, i);
         if (!value)
             continue;
 
-        Iec61850Utility::log_debug ("%s (included for reason %i)", entryName,
-                                    reason);
+        Iec61850Utility::log_debug ("%s (included for reason %i)",
+                                    entry.def->objRef.c_str (), reason);
+
+        if (con->m_reportQueue)
+            con->m_enqueueReportValue (&entry, value, unixTime);
+        else
+            con->m_client->handleValue (entry.def, value, entry.attribute,
+                                        entry.fc, unixTime);
+    }
+
+    // one wake-up per report, the report thread drains all its values
+    if (con->m_reportQueue)
+    {
+        std::lock_guard<std::mutex> lock (con->m_reportWaitLock);
+        con->m_reportAvailable.notify_one ();
+    }
+}
+
+void
+IEC61850ClientConnection::m_enqueueReportValue (const ReportEntry* entry,
+                                                MmsValue* value,
+                                                uint64_t timestamp)
+{
+    QueuedReportValue* slot = m_reportQueue->reserve ();
+
+    // a full queue is delivered on the receive thread, which holds off the
+    // IED until ingest has caught up instead of losing values
+    if (!slot)
+    {
+        if (m_reportQueueStalls++ % 1000 == 0)
+        {
+            Iec61850Utility::log_warn (
+                "Report queue full -> delivered on the receive thread (%lu "
+                "times)",
+                (unsigned long)m_reportQueueStalls.load ());
+        }
+
+        {
+            std::lock_guard<std::mutex> lock (m_reportDrainLock);
+            m_drainReportQueue ();
+        }
+
+        slot = m_reportQueue->reserve ();
+    }
+
+    // reuse the value of the slot to avoid an allocation per report entry
+    if (!slot->value || !MmsValue_update (slot->value, value))
+    {
+        if (slot->value)
+            MmsValue_delete (slot->value);
+        slot->value = MmsValue_clone (value);
+    }
+    slot->entry = entry;
+    slot->timestamp = timestamp;
+
+    m_reportQueue->commit ();
+
+    size_t depth = m_reportQueue->size ();
+    size_t highWaterMark = m_reportQueueHighWaterMark.load ();
+    while (depth > highWaterMark
+           && !m_reportQueueHighWaterMark.compare_exchange_weak (
+               highWaterMark, depth))
+        ;
+}
+
+void
+IEC61850ClientConnection::m_drainReportQueue ()
+{
+    QueuedReportValue* item;
+
+    while ((item = m_reportQueue->front ()) != nullptr)
+    {
+        if (item->value)
+        {
+            m_client->handleValue (item->entry->def, item->value,
+                                   item->entry->attribute, item->entry->fc,
+                                   item->timestamp);
+        }
+        item->entry = nullptr;
+        m_reportQueue->pop ();
+    }
+}
+
+void
+IEC61850ClientConnection::_reportThread ()
+{
+    std::unique_lock<std::mutex> lock (m_reportWaitLock);
+
+    while (!m_reportThreadStop)
+    {
+        m_reportAvailable.wait (lock, [this] {
+            return m_reportThreadStop || m_reportQueue->size () > 0;
+        });
+
+        lock.unlock ();
+        {
+            std::lock_guard<std::mutex> drainLock (m_reportDrainLock);
+            m_drainReportQueue ();
+        }
+        lock.lock ();
+    }
+}
+
+IEC61850ClientConnection::ReportDispatchTable*
+IEC61850ClientConnection::m_createReportDispatchTable (
+    LinkedList dataSetDirectory)
+{
+    auto table = new ReportDispatchTable;
+    table->connection = this;
+
+    LinkedList element = LinkedList_getNext (dataSetDirectory);
+
+    while (element)
+    {
+        auto* entryName = (char*)element->data;
+        ReportEntry entry{ nullptr, "", IEC61850_FC_NONE };
+        std::string objRef;
+
+        if (IEC61850Client::parseDataSetEntry (entryName, objRef,
+                                               entry.attribute, entry.fc))
+        {
+            entry.def = m_config->getExchangeDefinitionByObjRef (objRef);
+
+            if (!entry.def)
+            {
+                Iec61850Utility::log_debug (
+                    "No exchange definition found for %s", objRef.c_str ());
+            }
+        }
+
+        table->entries.push_back (entry);
 
-        con->m_client->handleValue (std::string (entryName), value, unixTime);
+        element = LinkedList_getNext (element);
     }
+
+    return table;
 }
 
 static int
@@ -390,189 +613,1413 @@ configureRcb (const std::shared_ptr<ReportSubscription>& rs,
     return parametersMask;
 }
 
-void
-IEC61850ClientConnection::m_configRcb ()
+LinkedList
+IEC61850ClientConnection::m_getDataSetDirectory (IedClientError* error,
+                                                 const std::string& dataSetRef)
 {
-    for (const auto& pair : m_config->getReportSubscriptions ())
-    {
-        IedClientError error;
-        std::shared_ptr<ReportSubscription> rs = pair.second;
-        ClientReportControlBlock rcb = nullptr;
-        ClientDataSet clientDataSet = nullptr;
-        LinkedList dataSetDirectory = nullptr;
-
-        std::stringstream ss;
-        ss << "reportsubscription - rcbref: " << rs->rcbRef
-           << ", datasetref: " << rs->datasetRef << ", trgops: " << rs->trgops
-           << ", buftm: " << rs->buftm << ", intgpd: " << rs->intgpd;
-        Iec61850Utility::log_debug ("%s", ss.str ().c_str ());
+    std::vector<std::string> entries;
 
-        dataSetDirectory = IedConnection_getDataSetDirectory (
-            m_connection, &error, rs->datasetRef.c_str (), nullptr);
+    if (m_modelCacheValid
+        && m_modelCache->getDataSetDirectory (dataSetRef, entries))
+    {
+        *error = IED_ERROR_OK;
 
-        if (error != IED_ERROR_OK)
+        LinkedList dataSetDirectory = LinkedList_create ();
+        for (const auto& entry : entries)
         {
-            Iec61850Utility::log_error (
-                "Reading data set directory failed!\n");
-            continue;
+            char* strCopy = static_cast<char*> (malloc (entry.length () + 1));
+            if (strCopy != nullptr)
+            {
+                std::strcpy (strCopy, entry.c_str ());
+                LinkedList_add (dataSetDirectory, static_cast<void*> (strCopy));
+            }
         }
+        return dataSetDirectory;
+    }
 
-        clientDataSet = IedConnection_readDataSetValues (
-            m_connection, &error, rs->datasetRef.c_str (), nullptr);
+    LinkedList dataSetDirectory = IedConnection_getDataSetDirectory (
+        m_connection, error, dataSetRef.c_str (), nullptr);
 
-        if (clientDataSet == nullptr)
+    if (*error == IED_ERROR_OK && m_modelCacheValid)
+    {
+        LinkedList element = LinkedList_getNext (dataSetDirectory);
+        while (element)
         {
-            Iec61850Utility::log_error ("Failed to read dataset\n");
-            continue;
+            entries.push_back ((char*)element->data);
+            element = LinkedList_getNext (element);
         }
+        m_modelCache->putDataSetDirectory (dataSetRef, entries);
+    }
 
-        rcb = IedConnection_getRCBValues (m_connection, &error,
-                                          rs->rcbRef.c_str (), nullptr);
-
-        if (error != IED_ERROR_OK)
-        {
-            Iec61850Utility::log_error ("GetRCBValues service error!\n");
-            continue;
-        }
+    return dataSetDirectory;
+}
 
-        uint32_t parametersMask = configureRcb (rs, rcb);
+void
+IEC61850ClientConnection::m_requestModelIdentity ()
+{
+    std::set<std::string> logicalDevices;
 
-        auto connDataSetPair
-            = new std::pair<IEC61850ClientConnection*, LinkedList> (
-                this, dataSetDirectory);
-        m_connDataSetDirectoryPairs.push_back (connDataSetPair);
+    for (const auto& def : m_config->ExchangeDefinition ())
+        logicalDevices.insert (def.objRef.substr (0, def.objRef.find ('/')));
 
-        IedConnection_installReportHandler (
-            m_connection,
-            (rs->rcbRef.substr (0, rs->rcbRef.size () - 2)).c_str (),
-            ClientReportControlBlock_getRptId (rcb), reportCallbackFunction,
-            static_cast<void*> (connDataSetPair));
+    std::lock_guard<std::mutex> lock (m_identityLock);
 
-        IedConnection_setRCBValues (m_connection, &error, rcb, parametersMask,
-                                    true);
+    m_identityGeneration++;
+    m_configRevisions.clear ();
+    m_outstandingIdentityReads = 0;
+    m_identityUnknown = false;
 
-        if (clientDataSet)
-            ClientDataSet_destroy (clientDataSet);
+    // all configRev reads are issued at once and answered while the read
+    // associations connect
+    for (const auto& logicalDevice : logicalDevices)
+    {
+        auto call = new IdentityCall{ this, m_identityGeneration,
+                                      logicalDevice };
+        m_identityCalls.insert (call);
 
-        if (rcb)
-            ClientReportControlBlock_destroy (rcb);
+        IedClientError err;
+        std::string objRef = logicalDevice + "/LLN0.NamPlt.configRev";
+        IedConnection_readObjectAsync (m_connection, &err, objRef.c_str (),
+                                       IEC61850_FC_DC, configRevHandler, call);
 
-        if (error != IED_ERROR_OK)
+        if (err != IED_ERROR_OK)
         {
-            m_client->logIedClientError (error, "Set RCB Values");
+            Iec61850Utility::log_warn (
+                "Cannot read %s -> model identity unknown", objRef.c_str ());
+            m_identityCalls.erase (call);
+            delete call;
+            m_identityUnknown = true;
             return;
         }
+
+        m_outstandingIdentityReads++;
     }
 }
 
 void
-IEC61850ClientConnection::m_setVarSpecs ()
+IEC61850ClientConnection::configRevHandler (uint32_t invokeId,
+                                            void* parameter,
+                                            IedClientError err,
+                                            MmsValue* value)
 {
-    IedClientError err;
-    for (const auto& entry : m_config->ExchangeDefinition ())
+    auto call = static_cast<IdentityCall*> (parameter);
+    IEC61850ClientConnection* connection = call->connection;
+
+    std::lock_guard<std::mutex> lock (connection->m_identityLock);
+
+    connection->m_identityCalls.erase (call);
+
+    // a response the bring-up gave up waiting for is dropped
+    if (call->generation == connection->m_identityGeneration)
     {
-        auto def = entry.second;
-        FunctionalConstraint fc = def->cdcType == MV || def->cdcType == APC
-                                      ? IEC61850_FC_MX
-                                      : IEC61850_FC_ST;
-        MmsVariableSpecification* spec
-            = getVariableSpec (&err, def->objRef.c_str (), fc);
-        if (spec)
+        if (err == IED_ERROR_OK && value
+            && MmsValue_getType (value) == MMS_VISIBLE_STRING)
+        {
+            connection->m_configRevisions[call->logicalDevice]
+                = MmsValue_toString (value);
+        }
+        else
         {
-            def->spec = spec;
+            Iec61850Utility::log_warn (
+                "Cannot read %s/LLN0.NamPlt.configRev -> model identity "
+                "unknown",
+                call->logicalDevice.c_str ());
+            connection->m_identityUnknown = true;
         }
+
+        connection->m_outstandingIdentityReads--;
+        connection->m_identityReceived.notify_one ();
     }
+
+    if (value)
+        MmsValue_delete (value);
+
+    delete call;
 }
 
-void
-IEC61850ClientConnection::m_initialiseControlObjects ()
+std::string
+IEC61850ClientConnection::m_awaitModelIdentity ()
 {
-    for (const auto& entry : m_config->ExchangeDefinition ())
+    std::unique_lock<std::mutex> lock (m_identityLock);
+
+    bool complete = m_identityReceived.wait_for (
+        lock, std::chrono::milliseconds (BRING_UP_TIMEOUT),
+        [this] { return m_outstandingIdentityReads == 0; });
+
+    if (!complete)
     {
-        auto def = entry.second;
-        if (def->cdcType < SPC || def->cdcType >= SPG)
-            continue;
-        IedClientError err;
-        MmsValue* temp = IedConnection_readObject (
-            m_connection, &err, def->objRef.c_str (), IEC61850_FC_ST);
-        if (err != IED_ERROR_OK)
-        {
-            m_client->logIedClientError (err, "Initialise control object");
-            continue;
-        }
-        MmsValue_delete (temp);
-        auto co = new ControlObjectStruct;
-        co->client
-            = ControlObjectClient_create (def->objRef.c_str (), m_connection);
-        co->mode = ControlObjectClient_getControlModel (co->client);
-        co->state = CONTROL_IDLE;
-        co->label = entry.first;
-        switch (def->cdcType)
-        {
-        case SPC:
-        case DPC: {
-            co->value = MmsValue_newBoolean (false);
-            break;
-        }
-        case BSC: {
-            co->value = MmsValue_newBitString (2);
-            break;
-        }
-        case APC: {
-            co->value = MmsValue_newFloat (0.0);
-            break;
-        }
-        case INC: {
-            co->value = MmsValue_newIntegerFromInt32 (0);
-            break;
-        }
-        default: {
-            Iec61850Utility::log_error ("Invalid cdc type");
-            return;
-        }
-        }
-        Iec61850Utility::log_debug ("Added control object %s , %s ",
-                                    co->label.c_str (), def->objRef.c_str ());
-        m_controlObjects.insert ({ def->objRef, co });
+        Iec61850Utility::log_warn (
+            "%d configRev reads still outstanding after %d ms -> model "
+            "identity unknown",
+            m_outstandingIdentityReads, BRING_UP_TIMEOUT);
     }
+
+    // responses still outstanding are dropped
+    m_identityGeneration++;
+    m_outstandingIdentityReads = 0;
+
+    if (!complete || m_identityUnknown)
+        return "";
+
+    std::string identity;
+
+    for (const auto& revision : m_configRevisions)
+        identity += revision.first + "=" + revision.second + ";";
+
+    return identity;
 }
 
 void
-IEC61850ClientConnection::Start ()
+IEC61850ClientConnection::m_validateModelCache ()
 {
-    if (!m_started)
-    {
-        m_started = true;
+    std::string identity = m_awaitModelIdentity ();
 
-        m_conThread
-            = new std::thread (&IEC61850ClientConnection::_conThread, this);
-    }
+    m_modelCacheValid = m_modelCache && m_modelCache->validate (identity);
+
+    // without an identity the model cannot be told apart from the one the
+    // specifications were read from
+    m_modelSource = identity.empty () ? ""
+                                      : m_serverIp + ":"
+                                            + std::to_string (m_tcpPort)
+                                            + " " + identity;
 }
 
 void
-IEC61850ClientConnection::cleanUp ()
+IEC61850ClientConnection::m_saveModelCache ()
 {
-    if (!m_config->ExchangeDefinition ().empty ())
-    {
-        for (const auto& def : m_config->ExchangeDefinition ())
-        {
-            if (def.second->spec)
-            {
-                MmsVariableSpecification_destroy (def.second->spec);
-                def.second->spec = nullptr;
-            }
-        }
-    }
+    if (m_modelCacheValid && m_modelCache->dirty ())
+        m_modelCache->save ();
+}
 
-    if (!m_connDataSetDirectoryPairs.empty ())
+bool
+IEC61850ClientConnection::m_subscribeReport (
+    const std::shared_ptr<ReportSubscription>& rs)
+{
+    IedClientError error;
+    ClientReportControlBlock rcb = nullptr;
+    LinkedList dataSetDirectory = nullptr;
+
+    std::stringstream ss;
+    ss << "reportsubscription - rcbref: " << rs->rcbRef
+       << ", datasetref: " << rs->datasetRef << ", trgops: " << rs->trgops
+       << ", buftm: " << rs->buftm << ", intgpd: " << rs->intgpd;
+    Iec61850Utility::log_debug ("%s", ss.str ().c_str ());
+
+    dataSetDirectory = m_getDataSetDirectory (&error, rs->datasetRef);
+
+    if (error != IED_ERROR_OK)
+    {
+        Iec61850Utility::log_error ("Reading data set directory failed!\n");
+        return false;
+    }
+
+    rcb = IedConnection_getRCBValues (m_connection, &error,
+                                      rs->rcbRef.c_str (), nullptr);
+
+    if (error != IED_ERROR_OK)
+    {
+        Iec61850Utility::log_error ("GetRCBValues service error!\n");
+        LinkedList_destroy (dataSetDirectory);
+        return false;
+    }
+
+    uint32_t parametersMask = configureRcb (rs, rcb);
+
+    ReportDispatchTable* table
+        = m_createReportDispatchTable (dataSetDirectory);
+    m_reportDispatchTables.push_back (table);
+
+    LinkedList_destroy (dataSetDirectory);
+
+    IedConnection_installReportHandler (
+        m_connection, (rs->rcbRef.substr (0, rs->rcbRef.size () - 2)).c_str (),
+        ClientReportControlBlock_getRptId (rcb), reportCallbackFunction,
+        static_cast<void*> (table));
+
+    IedConnection_setRCBValues (m_connection, &error, rcb, parametersMask,
+                                true);
+
+    if (rcb)
+        ClientReportControlBlock_destroy (rcb);
+
+    if (error != IED_ERROR_OK)
+    {
+        m_client->logIedClientError (error, "Set RCB Values");
+        return false;
+    }
+
+    return true;
+}
+
+void
+IEC61850ClientConnection::m_configRcb ()
+{
+    for (const auto& pair : m_config->getReportSubscriptions ())
+    {
+        m_subscribeReport (pair.second);
+    }
+
+    m_reportedDefinitions.clear ();
+
+    for (const auto& planned : m_plannedReports)
+    {
+        if (!m_subscribeReport (planned.subscription))
+            continue;
+
+        m_reportedDefinitions.insert (planned.definitions.begin (),
+                                      planned.definitions.end ());
+    }
+
+    if (!m_plannedReports.empty ())
+    {
+        Iec61850Utility::log_info (
+            "%d of %d polled datapoints are reported instead",
+            (int)m_reportedDefinitions.size (),
+            (int)m_config->polledDatapoints ().size ());
+    }
+}
+
+std::deque<std::string>
+IEC61850ClientConnection::m_findFreeRcbs (const std::string& ldName)
+{
+    std::deque<std::string> freeRcbs;
+    std::string lnRef = ldName + "/LLN0";
+
+    // unbuffered control blocks first, buffered ones only when these run out
+    const std::pair<ACSIClass, const char*> classes[]
+        = { { ACSI_CLASS_URCB, ".RP." }, { ACSI_CLASS_BRCB, ".BR." } };
+
+    for (const auto& acsiClass : classes)
+    {
+        IedClientError error;
+        LinkedList rcbNames = IedConnection_getLogicalNodeDirectory (
+            m_connection, &error, lnRef.c_str (), acsiClass.first);
+
+        if (error != IED_ERROR_OK)
+            continue;
+
+        LinkedList element = LinkedList_getNext (rcbNames);
+        while (element)
+        {
+            std::string rcbRef
+                = lnRef + acsiClass.second + (char*)element->data;
+            element = LinkedList_getNext (element);
+
+            if (m_config->getReportSubscriptions ().count (rcbRef))
+                continue;
+
+            ClientReportControlBlock rcb = IedConnection_getRCBValues (
+                m_connection, &error, rcbRef.c_str (), nullptr);
+
+            if (error != IED_ERROR_OK)
+                continue;
+
+            bool reserved = ClientReportControlBlock_getRptEna (rcb)
+                            || (!ClientReportControlBlock_isBuffered (rcb)
+                                && ClientReportControlBlock_getResv (rcb));
+
+            ClientReportControlBlock_destroy (rcb);
+
+            if (!reserved)
+                freeRcbs.push_back (rcbRef);
+        }
+
+        LinkedList_destroyDeep (rcbNames, free);
+    }
+
+    return freeRcbs;
+}
+
+void
+IEC61850ClientConnection::m_planReports ()
+{
+    m_plannedReports.clear ();
+
+    if (!m_config->getAutoReporting ())
+        return;
+
+    std::vector<PlannedDataset> plan = IEC61850ReportPlanner::plan (
+        m_config->polledDatapoints (), m_config->getMaxDatasetEntries ());
+    std::deque<PlannedDataset> pending (plan.begin (), plan.end ());
+    std::map<std::string, std::deque<std::string> > freeRcbs;
+
+    while (!pending.empty ())
+    {
+        PlannedDataset planned = pending.front ();
+        pending.pop_front ();
+
+        auto rcbs = freeRcbs.find (planned.ldName);
+        if (rcbs == freeRcbs.end ())
+        {
+            rcbs = freeRcbs
+                       .insert ({ planned.ldName,
+                                  m_findFreeRcbs (planned.ldName) })
+                       .first;
+        }
+
+        if (rcbs->second.empty ())
+        {
+            Iec61850Utility::log_warn (
+                "No free report control block in %s -> %d datapoints stay "
+                "polled",
+                planned.ldName.c_str (), (int)planned.definitions.size ());
+            continue;
+        }
+
+        bool created = false;
+
+        if (!m_provisionDataset (*planned.dataset, created))
+        {
+            // the server may support fewer members than configured
+            PlannedDataset first, second;
+            if (IEC61850ReportPlanner::split (planned, first, second))
+            {
+                pending.push_front (second);
+                pending.push_front (first);
+            }
+            continue;
+        }
+
+        auto rs = std::make_shared<ReportSubscription> ();
+        rs->rcbRef = rcbs->second.front ();
+        rs->datasetRef = planned.dataset->datasetRef;
+        rs->trgops = TRG_OPT_DATA_CHANGED | TRG_OPT_QUALITY_CHANGED
+                     | TRG_OPT_GI;
+        rs->buftm = -1;
+        rs->intgpd = -1;
+        rs->gi = true;
+        rcbs->second.pop_front ();
+
+        m_plannedReports.push_back ({ rs, planned.definitions });
+    }
+}
+
+static int
+childIndex (MmsVariableSpecification* spec, const char* name)
+{
+    int index = -1;
+
+    if (!spec || !name
+        || !MmsVariableSpecification_getChildSpecificationByName (spec, name,
+                                                                  &index))
+        return -1;
+
+    return index;
+}
+
+static void
+resolveElementIndices (DataExchangeDefinition& def)
+{
+    DataElementIndices& elements = def.elements;
+    const char* elementName = IEC61850Client::valueElementName (def.cdcType);
+
+    elements = DataElementIndices ();
+    elements.value = childIndex (def.spec, elementName);
+    elements.q = childIndex (def.spec, "q");
+    elements.t = childIndex (def.spec, "t");
+
+    MmsVariableSpecification* valueSpec
+        = elementName ? MmsVariableSpecification_getChildSpecificationByName (
+              def.spec, elementName, nullptr)
+                      : nullptr;
+
+    // objRef may already address the value attribute itself
+    if (!valueSpec && elementName)
+        valueSpec = def.spec;
+
+    elements.valueF = childIndex (valueSpec, "f");
+    elements.valueI = childIndex (valueSpec, "i");
+    elements.posVal = childIndex (valueSpec, "posVal");
+    elements.transInd = childIndex (valueSpec, "transInd");
+
+    // a minimal read lists value, q and t, so their indices are positions
+    // in that list; the value itself keeps its structure
+    def.minimalItems.clear ();
+    def.minimalElements = elements;
+
+    if (elements.value < 0)
+        return;
+
+    def.minimalElements.value = (int)def.minimalItems.size ();
+    def.minimalItems.push_back (elementName);
+
+    if (elements.q >= 0)
+    {
+        def.minimalElements.q = (int)def.minimalItems.size ();
+        def.minimalItems.push_back ("q");
+    }
+
+    if (elements.t >= 0)
+    {
+        def.minimalElements.t = (int)def.minimalItems.size ();
+        def.minimalItems.push_back ("t");
+    }
+
+    // the value alone is read as the whole object, which also keeps every
+    // variable list read at two or more results; so is an object that other
+    // definitions convert as well
+    if (def.minimalItems.size () < 2 || def.nextSameObjRef)
+        def.minimalItems.clear ();
+}
+
+void
+IEC61850ClientConnection::m_requestVarSpecs ()
+{
+    MmsSpecCache& specCache = m_config->specCache ();
+
+    std::lock_guard<std::mutex> lock (m_specLock);
+
+    m_specRequests.clear ();
+    m_specGeneration++;
+    m_nextSpecRequest = 0;
+    m_outstandingSpecRequests = 0;
+
+    // specifications are kept over reconnects to the same model only, a
+    // backup IED or a changed model may lay its data objects out otherwise
+    if (m_modelSource.empty () || m_modelSource != m_config->specSource ())
+        m_config->resetVariableSpecs (m_modelSource);
+
+    for (auto& entry : m_config->ExchangeDefinition ())
+    {
+        DataExchangeDefinition* def = &entry;
+
+        if (def->spec)
+            continue;
+
+        FunctionalConstraint fc = def->cdcType == MV || def->cdcType == APC
+                                      ? IEC61850_FC_MX
+                                      : IEC61850_FC_ST;
+        MmsVariableSpecification* spec
+            = m_modelCacheValid ? m_modelCache->getSpec (def->objRef, fc)
+                                : nullptr;
+
+        if (spec)
+        {
+            def->spec = specCache.intern (spec);
+            resolveElementIndices (*def);
+            continue;
+        }
+
+        m_specRequests.push_back ({ def, fc, nullptr });
+    }
+
+    m_specRequestsOpen = true;
+
+    while (m_issueNextSpecRequest ())
+        ;
+}
+
+bool
+IEC61850ClientConnection::m_issueNextSpecRequest ()
+{
+    if (m_nextSpecRequest >= m_specRequests.size ()
+        || m_outstandingSpecRequests >= m_readWindow ())
+        return false;
+
+    size_t index = m_nextSpecRequest++;
+    const PendingSpec& request = m_specRequests[index];
+
+    m_outstandingSpecRequests++;
+
+    auto call = new SpecCall{ this, m_specGeneration, index,
+                              m_acquireReadAssociation () };
+    m_specCalls.insert (call);
+
+    IedClientError err;
+    IedConnection_getVariableSpecificationAsync (
+        call->association ? call->association->connection : m_connection,
+        &err, request.def->objRef.c_str (), request.fc, varSpecHandler, call);
+
+    if (err != IED_ERROR_OK)
+    {
+        m_client->logIedClientError (err, "Get variable specification "
+                                              + request.def->objRef);
+        m_releaseReadAssociation (call->association);
+        m_specCalls.erase (call);
+        delete call;
+        m_outstandingSpecRequests--;
+
+        if (err == IED_ERROR_CONNECTION_LOST || err == IED_ERROR_NOT_CONNECTED)
+        {
+            m_nextSpecRequest = m_specRequests.size ();
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void
+IEC61850ClientConnection::varSpecHandler (uint32_t invokeId, void* parameter,
+                                          IedClientError err,
+                                          MmsVariableSpecification* spec)
+{
+    auto call = static_cast<SpecCall*> (parameter);
+    IEC61850ClientConnection* connection = call->connection;
+
+    std::lock_guard<std::mutex> lock (connection->m_specLock);
+
+    connection->m_releaseReadAssociation (call->association);
+    connection->m_specCalls.erase (call);
+
+    bool open = connection->m_specRequestsOpen
+                && call->generation == connection->m_specGeneration;
+    size_t index = call->request;
+
+    delete call;
+
+    // the bring-up gave up waiting for this response
+    if (!open)
+    {
+        if (spec)
+            MmsVariableSpecification_destroy (spec);
+        return;
+    }
+
+    PendingSpec& request = connection->m_specRequests[index];
+
+    if (err == IED_ERROR_OK)
+        request.spec = spec;
+    else
+        connection->m_client->logIedClientError (
+            err, "Get variable specification " + request.def->objRef);
+
+    connection->m_outstandingSpecRequests--;
+
+    if (err == IED_ERROR_CONNECTION_LOST || err == IED_ERROR_NOT_CONNECTED)
+        connection->m_nextSpecRequest = connection->m_specRequests.size ();
+
+    while (connection->m_issueNextSpecRequest ())
+        ;
+
+    connection->m_specsReceived.notify_one ();
+}
+
+void
+IEC61850ClientConnection::m_awaitVarSpecs ()
+{
+    MmsSpecCache& specCache = m_config->specCache ();
+
+    std::unique_lock<std::mutex> lock (m_specLock);
+
+    bool complete = m_specsReceived.wait_for (
+        lock, std::chrono::milliseconds (BRING_UP_TIMEOUT), [this] {
+            return m_outstandingSpecRequests == 0
+                   && m_nextSpecRequest >= m_specRequests.size ();
+        });
+
+    if (!complete)
+    {
+        Iec61850Utility::log_warn (
+            "%d variable specifications still outstanding after %d ms",
+            m_outstandingSpecRequests, BRING_UP_TIMEOUT);
+    }
+
+    m_specRequestsOpen = false;
+
+    for (auto& request : m_specRequests)
+    {
+        if (!request.spec)
+            continue;
+
+        if (m_modelCacheValid)
+            m_modelCache->putSpec (request.def->objRef, request.fc,
+                                   request.spec);
+
+        request.def->spec = specCache.intern (request.spec);
+        request.spec = nullptr;
+        resolveElementIndices (*request.def);
+    }
+
+    m_specRequests.clear ();
+
+    Iec61850Utility::log_debug ("%d distinct variable specifications for %d "
+                                "definitions",
+                                (int)specCache.size (),
+                                (int)m_config->ExchangeDefinition ().size ());
+}
+
+static bool
+objRefToMmsName (const std::string& objRef, FunctionalConstraint fc,
+                 std::string& domainId, std::string& itemId)
+{
+    size_t slashPos = objRef.find ('/');
+    size_t dotPos = objRef.find ('.', slashPos);
+
+    if (slashPos == std::string::npos || dotPos == std::string::npos)
+        return false;
+
+    domainId = objRef.substr (0, slashPos);
+    itemId = objRef.substr (slashPos + 1, dotPos - slashPos - 1) + "$"
+             + FunctionalConstraint_toString (fc) + "$"
+             + objRef.substr (dotPos + 1);
+    std::replace (itemId.begin (), itemId.end (), '.', '$');
+
+    return true;
+}
+
+static bool
+minimalReadItemIds (const DataExchangeDefinition* def, FunctionalConstraint fc,
+                    std::string& domainId, LinkedList itemIds)
+{
+    for (const auto& item : def->minimalItems)
+    {
+        std::string itemId;
+
+        if (!objRefToMmsName (def->objRef + "." + item, fc, domainId, itemId))
+            return false;
+
+        char* strCopy = static_cast<char*> (malloc (itemId.length () + 1));
+        if (strCopy == nullptr)
+            return false;
+        std::strcpy (strCopy, itemId.c_str ());
+        LinkedList_add (itemIds, static_cast<void*> (strCopy));
+    }
+
+    return true;
+}
+
+static IedClientError
+toIedClientError (MmsError mmsError)
+{
+    switch (mmsError)
+    {
+    case MMS_ERROR_NONE:
+        return IED_ERROR_OK;
+    case MMS_ERROR_CONNECTION_LOST:
+        return IED_ERROR_CONNECTION_LOST;
+    case MMS_ERROR_SERVICE_TIMEOUT:
+        return IED_ERROR_TIMEOUT;
+    default:
+        return IED_ERROR_UNKNOWN;
+    }
+}
+
+bool
+IEC61850ClientConnection::hasDataAccessError (MmsValue* value)
+{
+    if (!value || MmsValue_getType (value) == MMS_DATA_ACCESS_ERROR)
+        return true;
+
+    // the result of a variable list read carries one value per variable
+    if (MmsValue_getType (value) == MMS_ARRAY)
+    {
+        for (int i = 0; i < (int)MmsValue_getArraySize (value); i++)
+        {
+            MmsValue* element = MmsValue_getElement (value, i);
+            if (!element || MmsValue_getType (element) == MMS_DATA_ACCESS_ERROR)
+                return true;
+        }
+    }
+
+    return false;
+}
+
+static int
+estimateEncodedSize (MmsVariableSpecification* spec)
+{
+    if (!spec)
+        return POLL_BATCH_DEFAULT_ITEM_SIZE;
+
+    int size = std::abs (MmsVariableSpecification_getSize (spec));
+
+    switch (MmsVariableSpecification_getType (spec))
+    {
+    case MMS_STRUCTURE: {
+        int encodedSize = 4;
+        for (int i = 0; i < size; i++)
+        {
+            encodedSize += estimateEncodedSize (
+                MmsVariableSpecification_getChildSpecificationByIndex (spec,
+                                                                       i));
+        }
+        return encodedSize;
+    }
+    case MMS_ARRAY:
+        return 4
+               + size
+                     * estimateEncodedSize (
+                         MmsVariableSpecification_getArrayElementSpecification (
+                             spec));
+    case MMS_BOOLEAN:
+        return 3;
+    case MMS_INTEGER:
+    case MMS_UNSIGNED:
+    case MMS_FLOAT:
+    case MMS_BIT_STRING:
+        return 3 + (size + 7) / 8;
+    case MMS_UTC_TIME:
+        return 10;
+    case MMS_BINARY_TIME:
+        return 8;
+    case MMS_OCTET_STRING:
+    case MMS_VISIBLE_STRING:
+    case MMS_STRING:
+        return 3 + size;
+    default:
+        return POLL_BATCH_DEFAULT_ITEM_SIZE;
+    }
+}
+
+void
+IEC61850ClientConnection::m_preparePollBatches ()
+{
+    if (m_config->getPollingMode () != POLLING_BATCHED)
+        return;
+
+    MmsConnectionParameters parameters
+        = MmsConnection_getMmsConnectionParameters (
+            IedConnection_getMmsConnection (m_connection));
+
+    int maxPduSize = parameters.maxPduSize > 0 ? parameters.maxPduSize
+                                               : DEFAULT_MAX_PDU_SIZE;
+    int budget = maxPduSize - POLL_BATCH_PDU_OVERHEAD;
+
+    for (const auto& schedule : m_pollSchedules)
+    {
+        size_t first = m_pollBatches.size ();
+        m_preparePollBatches (schedule.group.get (), budget);
+
+        // spread the batches of the group evenly over its slices
+        size_t batchCount = m_pollBatches.size () - first;
+        size_t sliceCount = schedule.slices.size ();
+        for (size_t i = 0; i < batchCount; i++)
+        {
+            m_pollBatches[first + i]->group
+                = schedule.slices[i * sliceCount / batchCount].get ();
+        }
+    }
+
+    Iec61850Utility::log_debug (
+        "Prepared %d poll batches for %d polled datapoints (max PDU %d)",
+        (int)m_pollBatches.size (), (int)m_config->polledDatapoints ().size (),
+        maxPduSize);
+}
+
+void
+IEC61850ClientConnection::m_preparePollBatches (
+    const PollingGroup* pollingGroup, int budget)
+{
+    std::map<std::pair<std::string, FunctionalConstraint>,
+             std::map<std::string, DataExchangeDefinition*> >
+        groups;
+
+    for (const auto& entry : pollingGroup->polledDatapoints)
+    {
+        auto def = entry.second;
+
+        if (m_reportedDefinitions.count (def))
+            continue;
+
+        FunctionalConstraint fc = def->cdcType == MV || def->cdcType == APC
+                                      ? IEC61850_FC_MX
+                                      : IEC61850_FC_ST;
+        std::string domainId = def->objRef.substr (0, def->objRef.find ('/'));
+        groups[{ domainId, fc }].insert ({ def->objRef, def });
+    }
+
+    for (const auto& group : groups)
+    {
+        PollBatch* batch = nullptr;
+        int requestSize = 0;
+        int responseSize = 0;
+
+        for (const auto& entry : group.second)
+        {
+            auto def = entry.second;
+            std::string domainId;
+            std::string itemId;
+
+            if (!objRefToMmsName (def->objRef, group.first.second, domainId,
+                                  itemId))
+            {
+                Iec61850Utility::log_error (
+                    "Cannot derive MMS name of %s -> not polled",
+                    def->objRef.c_str ());
+                continue;
+            }
+
+            bool minimal
+                = m_config->getMinimalReads () && !def->minimalItems.empty ();
+
+            int itemRequestSize = POLL_BATCH_ITEM_OVERHEAD
+                                  + (int)domainId.size ()
+                                  + (int)itemId.size ();
+            int itemResponseSize = estimateEncodedSize (def->spec);
+
+            if (minimal)
+            {
+                itemRequestSize = 0;
+                itemResponseSize = 0;
+                for (const auto& item : def->minimalItems)
+                {
+                    itemRequestSize += POLL_BATCH_ITEM_OVERHEAD
+                                       + (int)domainId.size ()
+                                       + (int)itemId.size ()
+                                       + (int)item.size () + 1;
+                    itemResponseSize += estimateEncodedSize (
+                        MmsVariableSpecification_getChildSpecificationByName (
+                            def->spec, item.c_str (), nullptr));
+                }
+            }
+
+            if (batch
+                && (requestSize + itemRequestSize > budget
+                    || responseSize + itemResponseSize > budget))
+            {
+                batch = nullptr;
+            }
+
+            if (!batch)
+            {
+                batch = new PollBatch;
+                batch->group = pollingGroup;
+                batch->domainId = domainId;
+                batch->fc = group.first.second;
+                batch->itemIds = LinkedList_create ();
+                m_pollBatches.push_back (batch);
+                requestSize = 0;
+                responseSize = 0;
+            }
+
+            if (minimal)
+            {
+                if (!minimalReadItemIds (def, group.first.second, domainId,
+                                         batch->itemIds))
+                    continue;
+                batch->itemCounts.push_back ((int)def->minimalItems.size ());
+                batch->definitions.push_back (def);
+
+                requestSize += itemRequestSize;
+                responseSize += itemResponseSize;
+                continue;
+            }
+
+            char* strCopy = static_cast<char*> (malloc (itemId.length () + 1));
+            if (strCopy == nullptr)
+                continue;
+            std::strcpy (strCopy, itemId.c_str ());
+            LinkedList_add (batch->itemIds, static_cast<void*> (strCopy));
+            batch->itemCounts.push_back (0);
+            batch->definitions.push_back (def);
+
+            requestSize += itemRequestSize;
+            responseSize += itemResponseSize;
+        }
+    }
+}
+
+void
+IEC61850ClientConnection::m_preparePollSchedules ()
+{
+    m_pollSchedules.clear ();
+
+    for (const auto& group : m_config->getPollingGroups ())
+    {
+        PollSchedule schedule{ group, {}, 0, 0, 0, 0, 0 };
+
+        std::map<std::string, DataExchangeDefinition*> sorted (
+            group->polledDatapoints.begin (), group->polledDatapoints.end ());
+
+        for (const auto& def : m_reportedDefinitions)
+            sorted.erase (def->objRef);
+
+        size_t count = std::max<size_t> (sorted.size (), 1);
+        size_t sliceCount = std::min<size_t> (
+            count, std::max<long> (group->interval / POLL_SCHEDULER_TICK, 1));
+
+        for (size_t i = 0; i < sliceCount; i++)
+        {
+            auto slice = std::make_shared<PollingGroup> ();
+            slice->name = group->name;
+            slice->interval = group->interval;
+            schedule.slices.push_back (slice);
+        }
+
+        size_t i = 0;
+        for (const auto& entry : sorted)
+        {
+            schedule.slices[i * sliceCount / count]->polledDatapoints.insert (
+                entry);
+            i++;
+        }
+
+        schedule.nextSlice = schedule.slices.size ();
+        m_pollSchedules.push_back (schedule);
+    }
+}
+
+bool
+IEC61850ClientConnection::m_pollCycleRunning (const PollSchedule& schedule)
+{
+    if (schedule.nextSlice < schedule.slices.size ())
+        return true;
+
+    std::lock_guard<std::mutex> lock (m_pollLock);
+
+    for (const auto& group : m_pipelinedGroups)
+    {
+        for (const auto& slice : schedule.slices)
+        {
+            if (group.group == slice.get ()
+                && (group.outstandingReads > 0
+                    || group.nextPollIndex < group.definitions.size ()))
+                return true;
+        }
+    }
+
+    return false;
+}
+
+void
+IEC61850ClientConnection::m_runPollSchedule (PollSchedule& schedule,
+                                             uint64_t currentTime)
+{
+    uint64_t interval = schedule.group->interval;
+
+    if (currentTime >= schedule.nextPollingTime)
+    {
+        if (schedule.nextPollingTime == 0)
+            schedule.nextPollingTime = currentTime;
+
+        uint64_t missed = (currentTime - schedule.nextPollingTime) / interval;
+        if (missed > 0)
+        {
+            schedule.skippedCycles += missed;
+            schedule.nextPollingTime += missed * interval;
+        }
+
+        if (m_pollCycleRunning (schedule))
+        {
+            schedule.overruns++;
+            schedule.skippedCycles++;
+            Iec61850Utility::log_warn (
+                "Polling group %s overran its interval of %ld ms -> cycle "
+                "skipped (overruns: %lu, skipped cycles: %lu)",
+                schedule.group->name.c_str (), schedule.group->interval,
+                (unsigned long)schedule.overruns,
+                (unsigned long)schedule.skippedCycles);
+        }
+        else
+        {
+            schedule.cycleStart = schedule.nextPollingTime;
+            schedule.nextSlice = 0;
+        }
+
+        schedule.nextPollingTime += interval;
+    }
+
+    while (schedule.nextSlice < schedule.slices.size ()
+           && currentTime >= schedule.cycleStart
+                                 + schedule.nextSlice * interval
+                                       / schedule.slices.size ())
+    {
+        m_client->handleAllValues (schedule.slices[schedule.nextSlice++]);
+    }
+}
+
+void
+IEC61850ClientConnection::m_preparePipelinedPolling ()
+{
+    if (m_config->getPollingMode () != POLLING_PIPELINED)
+        return;
+
+    std::lock_guard<std::mutex> lock (m_pollLock);
+
+    m_pipelinedGroups.clear ();
+    for (const auto& schedule : m_pollSchedules)
+    {
+        for (const auto& slice : schedule.slices)
+        {
+            PipelinedGroup group;
+            group.group = slice.get ();
+            for (const auto& entry : slice->polledDatapoints)
+            {
+                group.definitions.push_back (entry.second);
+            }
+            group.nextPollIndex = group.definitions.size ();
+            group.outstandingReads = 0;
+            m_pipelinedGroups.push_back (group);
+        }
+    }
+
+    int window = m_readWindow ();
+
+    m_pendingReads.assign (window,
+                           { this, nullptr, nullptr, IEC61850_FC_ST, nullptr });
+    m_freeReadSlots.clear ();
+    for (auto& slot : m_pendingReads)
+    {
+        m_freeReadSlots.push_back (&slot);
+    }
+
+    Iec61850Utility::log_debug (
+        "Prepared pipelined polling of %d groups (%d reads in flight)",
+        (int)m_pipelinedGroups.size (), window);
+}
+
+void
+IEC61850ClientConnection::m_resetPipelinedPolling ()
+{
+    std::lock_guard<std::mutex> lock (m_pollLock);
+
+    m_freeReadSlots.clear ();
+    m_pendingReads.clear ();
+    m_pipelinedGroups.clear ();
+}
+
+bool
+IEC61850ClientConnection::m_issueNextRead ()
+{
+    if (m_freeReadSlots.empty ())
+        return false;
+
+    PipelinedGroup* group = nullptr;
+    for (auto& pipelinedGroup : m_pipelinedGroups)
+    {
+        if (pipelinedGroup.nextPollIndex < pipelinedGroup.definitions.size ())
+        {
+            group = &pipelinedGroup;
+            break;
+        }
+    }
+
+    if (!group)
+        return false;
+
+    PendingRead* slot = m_freeReadSlots.back ();
+    m_freeReadSlots.pop_back ();
+
+    slot->group = group;
+    slot->def = group->definitions[group->nextPollIndex++];
+    slot->fc = slot->def->cdcType == MV || slot->def->cdcType == APC
+                   ? IEC61850_FC_MX
+                   : IEC61850_FC_ST;
+
+    group->outstandingReads++;
+
+    slot->association = m_acquireReadAssociation ();
+    IedConnection connection
+        = slot->association ? slot->association->connection : m_connection;
+
+    IedClientError err;
+
+    if (m_config->getMinimalReads () && !slot->def->minimalItems.empty ())
+    {
+        std::string domainId;
+        LinkedList itemIds = LinkedList_create ();
+        MmsError mmsError = MMS_ERROR_NONE;
+
+        if (minimalReadItemIds (slot->def, slot->fc, domainId, itemIds))
+        {
+            MmsConnection_readMultipleVariablesAsync (
+                IedConnection_getMmsConnection (connection), &mmsError,
+                domainId.c_str (), itemIds, readVariablesHandler, slot);
+            err = toIedClientError (mmsError);
+        }
+        else
+        {
+            err = IED_ERROR_OBJECT_REFERENCE_INVALID;
+        }
+
+        LinkedList_destroyDeep (itemIds, free);
+    }
+    else
+    {
+        IedConnection_readObjectAsync (connection, &err,
+                                       slot->def->objRef.c_str (), slot->fc,
+                                       readObjectHandler, slot);
+    }
+
+    if (err != IED_ERROR_OK)
+    {
+        m_client->logIedClientError (err, "Pipelined read "
+                                              + slot->def->objRef);
+        m_releaseReadAssociation (slot->association);
+        slot->def = nullptr;
+        m_freeReadSlots.push_back (slot);
+        group->outstandingReads--;
+
+        if (err == IED_ERROR_CONNECTION_LOST || err == IED_ERROR_NOT_CONNECTED)
+        {
+            m_abortPipelinedPolling ();
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void
+IEC61850ClientConnection::m_abortPipelinedPolling ()
+{
+    for (auto& group : m_pipelinedGroups)
+    {
+        group.nextPollIndex = group.definitions.size ();
+    }
+}
+
+void
+IEC61850ClientConnection::readObjectHandler (uint32_t invokeId,
+                                             void* parameter,
+                                             IedClientError err,
+                                             MmsValue* value)
+{
+    auto slot = static_cast<PendingRead*> (parameter);
+
+    slot->connection->m_completeRead (slot, err, value, "");
+}
+
+void
+IEC61850ClientConnection::readVariablesHandler (uint32_t invokeId,
+                                                void* parameter,
+                                                MmsError err, MmsValue* value)
+{
+    auto slot = static_cast<PendingRead*> (parameter);
+
+    slot->connection->m_completeRead (slot, toIedClientError (err), value,
+                                      MINIMAL_READ_ATTRIBUTE);
+}
+
+void
+IEC61850ClientConnection::m_completeRead (PendingRead* slot,
+                                          IedClientError err, MmsValue* value,
+                                          const std::string& attribute)
+{
+    if (err == IED_ERROR_OK && !hasDataAccessError (value))
+    {
+        m_client->handlePolledValue (slot->def, value, attribute, slot->fc);
+    }
+    else
+    {
+        m_client->logIedClientError (err,
+                                     "Pipelined read " + slot->def->objRef);
+    }
+
+    if (value)
+        MmsValue_delete (value);
+
+    std::lock_guard<std::mutex> lock (m_pollLock);
+
+    m_releaseReadAssociation (slot->association);
+    slot->def = nullptr;
+    slot->group->outstandingReads--;
+    m_freeReadSlots.push_back (slot);
+
+    if (err == IED_ERROR_CONNECTION_LOST || err == IED_ERROR_NOT_CONNECTED)
+    {
+        m_abortPipelinedPolling ();
+        return;
+    }
+
+    while (m_issueNextRead ())
+        ;
+}
+
+void
+IEC61850ClientConnection::pollPipelined (const PollingGroup* pollingGroup)
+{
+    std::lock_guard<std::mutex> lock (m_pollLock);
+
+    for (auto& group : m_pipelinedGroups)
+    {
+        if (group.group != pollingGroup)
+            continue;
+
+        if (group.outstandingReads > 0
+            || group.nextPollIndex < group.definitions.size ())
+        {
+            Iec61850Utility::log_warn (
+                "Polling group %s still has %d reads outstanding -> cycle "
+                "skipped",
+                pollingGroup->name.c_str (), group.outstandingReads);
+            return;
+        }
+
+        group.nextPollIndex = 0;
+        break;
+    }
+
+    while (m_issueNextRead ())
+        ;
+}
+
+void
+IEC61850ClientConnection::m_initialiseControlObjects ()
+{
+    for (const auto& entry : m_config->ExchangeDefinition ())
+    {
+        const DataExchangeDefinition* def = &entry;
+        if (def->cdcType < SPC || def->cdcType >= SPG)
+            continue;
+
+        ControlObjectClient client = nullptr;
+        ControlModel mode;
+        MmsVariableSpecification* coSpec
+            = m_modelCacheValid
+                  ? m_modelCache->getSpec (def->objRef, IEC61850_FC_CO)
+                  : nullptr;
+
+        if (coSpec && m_modelCache->getControlModel (def->objRef, mode))
+        {
+            client = ControlObjectClient_createEx (
+                def->objRef.c_str (), m_connection, mode, coSpec);
+        }
+
+        if (coSpec)
+            MmsVariableSpecification_destroy (coSpec);
+
+        if (!client)
+        {
+            IedClientError err;
+            MmsValue* temp = IedConnection_readObject (
+                m_connection, &err, def->objRef.c_str (), IEC61850_FC_ST);
+            if (err != IED_ERROR_OK)
+            {
+                m_client->logIedClientError (err,
+                                             "Initialise control object");
+                continue;
+            }
+            MmsValue_delete (temp);
+            client = ControlObjectClient_create (def->objRef.c_str (),
+                                                 m_connection);
+            if (!client)
+                continue;
+            mode = ControlObjectClient_getControlModel (client);
+
+            if (m_modelCacheValid)
+            {
+                coSpec = getVariableSpec (&err, def->objRef.c_str (),
+                                          IEC61850_FC_CO);
+                if (coSpec)
+                {
+                    m_modelCache->putSpec (def->objRef, IEC61850_FC_CO,
+                                           coSpec);
+                    m_modelCache->putControlModel (def->objRef, mode);
+                    MmsVariableSpecification_destroy (coSpec);
+                }
+            }
+        }
+
+        auto co = new ControlObjectStruct;
+        co->client = client;
+        co->mode = mode;
+        co->state = CONTROL_IDLE;
+        co->label = def->label;
+        co->ready = false;
+        switch (def->cdcType)
+        {
+        case SPC:
+        case DPC: {
+            co->value = MmsValue_newBoolean (false);
+            break;
+        }
+        case BSC: {
+            co->value = MmsValue_newBitString (2);
+            break;
+        }
+        case APC: {
+            co->value = MmsValue_newFloat (0.0);
+            break;
+        }
+        case INC: {
+            co->value = MmsValue_newIntegerFromInt32 (0);
+            break;
+        }
+        default: {
+            Iec61850Utility::log_error ("Invalid cdc type");
+            return;
+        }
+        }
+        Iec61850Utility::log_debug ("Added control object %s , %s ",
+                                    co->label.c_str (), def->objRef.c_str ());
+        m_controlObjects.insert ({ def->objRef, co });
+    }
+}
+
+void
+IEC61850ClientConnection::Start ()
+{
+    if (!m_started)
+    {
+        m_started = true;
+
+        m_conThread
+            = new std::thread (&IEC61850ClientConnection::_conThread, this);
+
+        if (m_reportQueue)
+        {
+            m_reportThreadStop = false;
+            m_reportThread = new std::thread (
+                &IEC61850ClientConnection::_reportThread, this);
+        }
+    }
+}
+
+void
+IEC61850ClientConnection::cleanUp ()
+{
+    if (!m_pollBatches.empty ())
+    {
+        for (const auto& batch : m_pollBatches)
+        {
+            LinkedList_destroyDeep (batch->itemIds, free);
+            delete batch;
+        }
+        m_pollBatches.clear ();
+    }
+
+    // queued commands were never sent, so no timeout runs for them
+    std::vector<FailedControl> failed;
+
+    {
+        std::lock_guard<std::mutex> lock (m_controlLock);
+        for (const auto& co : m_controlObjects)
+        {
+            if (!co.second)
+                continue;
+
+            for (const auto& command : co.second->queue)
+                failed.push_back ({ command.commandId, co.second->label });
+        }
+    }
+
+    IedClientError err;
+
+    m_closeReadAssociations ();
+
+    if (m_connection)
+    {
+        IedConnection_close (m_connection);
+        IedConnection_abortAsync (m_connection, &err);
+    }
+
+    // no select, operate or termination can be answered any more; the
+    // control clients unregister from the connection, so they go before it
+    for (auto& co : m_controlObjects)
     {
-        for (const auto& entry : m_connDataSetDirectoryPairs)
+        ControlObjectStruct* cos = co.second;
+        if (cos && cos->client)
         {
-            LinkedList dataSetDirectory = entry->second;
-            LinkedList_destroy (dataSetDirectory);
-            delete entry;
+            ControlObjectClient_destroy (cos->client);
+            cos->client = nullptr;
         }
-        m_connDataSetDirectoryPairs.clear ();
+    }
+
+    if (m_connection)
+    {
+        IedConnection_destroy (m_connection);
+        m_connection = nullptr;
+    }
+
+    // the contexts and control objects were the parameters of the control
+    // handlers
+    {
+        std::lock_guard<std::mutex> lock (m_controlLock);
+        m_pendingControls.clear ();
+        m_readyControls.clear ();
+        m_freeCommandContexts.clear ();
+        m_commandContexts.clear ();
     }
 
     if (!m_controlObjects.empty ())
@@ -582,12 +2029,6 @@ IEC61850ClientConnection::cleanUp ()
             ControlObjectStruct* cos = co.second;
             if (cos)
             {
-                if (cos->client)
-                {
-                    if (cos->client)
-                        ControlObjectClient_destroy (cos->client);
-                    cos->client = nullptr;
-                }
                 if (cos->value)
                 {
                     MmsValue_delete (cos->value);
@@ -599,23 +2040,51 @@ IEC61850ClientConnection::cleanUp ()
         m_controlObjects.clear ();
     }
 
-    if (!m_connControlPairs.empty ())
+    m_reportFailedControls (failed);
+
+    m_resetPipelinedPolling ();
+
+    // no response can arrive any more for requests still outstanding
+    {
+        std::lock_guard<std::mutex> lock (m_specLock);
+        for (SpecCall* call : m_specCalls)
+            delete call;
+        m_specCalls.clear ();
+    }
+    {
+        std::lock_guard<std::mutex> lock (m_identityLock);
+        for (IdentityCall* call : m_identityCalls)
+            delete call;
+        m_identityCalls.clear ();
+    }
+
+    // reports received before the connection was closed are still
+    // delivered; the dispatch tables are the parameter of the report
+    // callbacks and queued values point into them
     {
-        for (auto& cc : m_connControlPairs)
+        std::lock_guard<std::mutex> drainLock (m_reportDrainLock);
+
+        if (m_reportQueue)
+            m_drainReportQueue ();
+
+        for (const auto& table : m_reportDispatchTables)
         {
-            delete cc;
+            delete table;
         }
-        m_connControlPairs.clear ();
+        m_reportDispatchTables.clear ();
     }
 
-    IedClientError err;
+    // polled values are compared with the last ones until no read can
+    // complete and no conversion is left
+    m_client->drainConversions ();
 
-    if (m_connection)
+    for (auto& def : m_config->ExchangeDefinition ())
     {
-        IedConnection_close (m_connection);
-        IedConnection_abortAsync (m_connection, &err);
-        IedConnection_destroy (m_connection);
-        m_connection = nullptr;
+        if (def.lastPolledValue)
+        {
+            MmsValue_delete (def.lastPolledValue);
+            def.lastPolledValue = nullptr;
+        }
     }
 
     if (m_tlsConfig != nullptr)
@@ -635,12 +2104,24 @@ IEC61850ClientConnection::Stop ()
         std::lock_guard<std::mutex> lock (m_conLock);
         m_started = false;
     }
+    m_wakeUp ();
     if (m_conThread)
     {
         m_conThread->join ();
         delete m_conThread;
         m_conThread = nullptr;
     }
+    if (m_reportThread)
+    {
+        {
+            std::lock_guard<std::mutex> lock (m_reportWaitLock);
+            m_reportThreadStop = true;
+            m_reportAvailable.notify_one ();
+        }
+        m_reportThread->join ();
+        delete m_reportThread;
+        m_reportThread = nullptr;
+    }
 }
 
 bool
@@ -803,54 +2284,345 @@ IEC61850ClientConnection::prepareConnection ()
         }
         else
         {
-            TLSConfiguration_setChainValidation (tlsConfig, false);
+            TLSConfiguration_setChainValidation (tlsConfig, false);
+        }
+
+        if (tlsConfigOk)
+        {
+
+            TLSConfiguration_setRenegotiationTime (tlsConfig, 60000);
+
+            m_connection = IedConnection_createWithTlsSupport (tlsConfig);
+
+            if (m_connection)
+            {
+                m_tlsConfig = tlsConfig;
+            }
+            else
+            {
+                printf ("TLS configuration failed\n");
+                TLSConfiguration_destroy (tlsConfig);
+            }
+        }
+        else
+        {
+            printf ("TLS configuration failed\n");
+            Iec61850Utility::log_error ("TLS configuration failed");
+        }
+    }
+    else
+    {
+        m_connection = IedConnection_create ();
+    }
+
+    return m_connection != nullptr;
+}
+
+void
+IEC61850ClientConnection::Disconnect ()
+{
+    // the connection thread may be in the middle of a bring-up that uses
+    // the connection, so it is the one that closes it
+    {
+        std::lock_guard<std::mutex> lock (m_conLock);
+        m_connect = false;
+        m_disconnectPending = true;
+    }
+    m_wakeUp ();
+}
+
+void
+IEC61850ClientConnection::m_closeConnection ()
+{
+    {
+        std::lock_guard<std::mutex> lock (m_conLock);
+        m_connecting = false;
+        m_connected = false;
+        m_connectionState = CON_STATE_IDLE;
+    }
+    cleanUp ();
+    m_client->connectionStateChanged ();
+}
+
+void
+IEC61850ClientConnection::Connect ()
+{
+    {
+        std::lock_guard<std::mutex> lock (m_conLock);
+        m_connect = true;
+    }
+    m_wakeUp ();
+}
+
+void
+IEC61850ClientConnection::m_wakeUp ()
+{
+    {
+        std::lock_guard<std::mutex> lock (m_wakeUpLock);
+        m_wakeUpPending = true;
+    }
+    m_wakeUpEvent.notify_one ();
+}
+
+void
+IEC61850ClientConnection::stateChangedHandler (void* parameter,
+                                               IedConnection connection,
+                                               IedConnectionState newState)
+{
+    auto self = static_cast<IEC61850ClientConnection*> (parameter);
+
+    self->m_wakeUp ();
+}
+
+uint64_t
+IEC61850ClientConnection::m_nextWakeUpTime ()
+{
+    std::lock_guard<std::mutex> lock (m_conLock);
+
+    if (m_disconnectPending)
+        return 0;
+
+    if (!m_started || !m_connect)
+        return UINT64_MAX;
+
+    switch (m_connectionState)
+    {
+    case CON_STATE_IDLE:
+    case CON_STATE_CLOSED:
+        return 0;
+    case CON_STATE_CONNECTING:
+    case CON_STATE_WAIT_FOR_RECONNECT:
+        return m_delayExpirationTime;
+    case CON_STATE_CONNECTED:
+        break;
+    default:
+        return UINT64_MAX;
+    }
+
+    uint64_t wakeUpTime = UINT64_MAX;
+
+    {
+        std::lock_guard<std::mutex> contextLock (m_controlLock);
+
+        for (const CommandContext* context : m_pendingControls)
+        {
+            wakeUpTime = std::min (wakeUpTime, context->deadline);
+        }
+    }
+
+    for (const auto& schedule : m_pollSchedules)
+    {
+        wakeUpTime = std::min (wakeUpTime, schedule.nextPollingTime);
+
+        if (schedule.nextSlice < schedule.slices.size ())
+        {
+            wakeUpTime = std::min<uint64_t> (
+                wakeUpTime, schedule.cycleStart
+                                + schedule.nextSlice * schedule.group->interval
+                                      / schedule.slices.size ());
+        }
+    }
+
+    return wakeUpTime;
+}
+
+void
+IEC61850ClientConnection::m_waitForWakeUp (uint64_t wakeUpTime)
+{
+    std::unique_lock<std::mutex> lock (m_wakeUpLock);
+
+    auto woken = [this] { return m_wakeUpPending; };
+
+    if (wakeUpTime == UINT64_MAX)
+    {
+        m_wakeUpEvent.wait (lock, woken);
+    }
+    else
+    {
+        uint64_t currentTime = getMonotonicTimeInMs ();
+
+        if (wakeUpTime > currentTime)
+        {
+            m_wakeUpEvent.wait_for (
+                lock, std::chrono::milliseconds (wakeUpTime - currentTime),
+                woken);
+        }
+    }
+
+    m_wakeUpPending = false;
+}
+
+IedConnection
+IEC61850ClientConnection::m_createAssociation ()
+{
+    IedConnection connection = m_tlsConfig
+                                   ? IedConnection_createWithTlsSupport (
+                                       m_tlsConfig)
+                                   : IedConnection_create ();
+
+    if (connection && m_osiParameters)
+        m_setOsiConnectionParameters (connection);
+
+    return connection;
+}
+
+void
+IEC61850ClientConnection::m_openReadAssociations ()
+{
+    for (int i = 1; i < m_config->getAssociations (); i++)
+    {
+        IedClientError error;
+        IedConnection connection = m_createAssociation ();
+
+        if (!connection)
+            continue;
+
+        IedConnection_installStateChangedHandler (
+            connection, readAssociationStateHandler, this);
+        IedConnection_connectAsync (connection, &error, m_serverIp.c_str (),
+                                    m_tcpPort);
+
+        if (error != IED_ERROR_OK)
+        {
+            m_client->logIedClientError (error, "Open read association");
+            IedConnection_destroy (connection);
+            continue;
         }
 
-        if (tlsConfigOk)
+        m_readAssociations.push_back ({ connection, 0 });
+    }
+}
+
+void
+IEC61850ClientConnection::readAssociationStateHandler (
+    void* parameter, IedConnection connection, IedConnectionState newState)
+{
+    auto self = static_cast<IEC61850ClientConnection*> (parameter);
+
+    // libiec61850 calls this with the state of the association locked, so
+    // only the change is counted here and the state is read by the waiter
+    std::lock_guard<std::mutex> lock (self->m_readAssociationWaitLock);
+    self->m_readAssociationStateChanges++;
+    self->m_readAssociationStateChanged.notify_all ();
+}
+
+void
+IEC61850ClientConnection::m_awaitReadAssociations ()
+{
+    auto expirationTime = std::chrono::steady_clock::now ()
+                          + std::chrono::milliseconds (BRING_UP_TIMEOUT);
+    auto it = m_readAssociations.begin ();
+
+    while (it != m_readAssociations.end ())
+    {
+        uint64_t changes;
         {
+            std::lock_guard<std::mutex> lock (m_readAssociationWaitLock);
+            changes = m_readAssociationStateChanges;
+        }
 
-            TLSConfiguration_setRenegotiationTime (tlsConfig, 60000);
+        IedConnectionState state = IedConnection_getState (it->connection);
 
-            m_connection = IedConnection_createWithTlsSupport (tlsConfig);
+        if (state == IED_STATE_CONNECTING)
+        {
+            std::unique_lock<std::mutex> lock (m_readAssociationWaitLock);
 
-            if (m_connection)
-            {
-                m_tlsConfig = tlsConfig;
-            }
-            else
-            {
-                printf ("TLS configuration failed\n");
-                TLSConfiguration_destroy (tlsConfig);
-            }
+            if (m_readAssociationStateChanged.wait_until (
+                    lock, expirationTime, [this, changes] {
+                        return m_readAssociationStateChanges != changes;
+                    }))
+                continue;
         }
-        else
+
+        if (state == IED_STATE_CONNECTED)
         {
-            printf ("TLS configuration failed\n");
-            Iec61850Utility::log_error ("TLS configuration failed");
+            ++it;
+            continue;
         }
+
+        Iec61850Utility::log_warn ("Read association to %s:%d failed",
+                                   m_serverIp.c_str (), m_tcpPort);
+        IedClientError error;
+        IedConnection_abortAsync (it->connection, &error);
+        IedConnection_destroy (it->connection);
+        it = m_readAssociations.erase (it);
     }
-    else
+
+    if (!m_readAssociations.empty ())
     {
-        m_connection = IedConnection_create ();
+        Iec61850Utility::log_info ("%d read associations open to %s:%d",
+                                   (int)m_readAssociations.size (),
+                                   m_serverIp.c_str (), m_tcpPort);
     }
-
-    return m_connection != nullptr;
 }
 
 void
-IEC61850ClientConnection::Disconnect ()
+IEC61850ClientConnection::m_closeReadAssociations ()
 {
-    m_connecting = false;
-    m_connected = false;
-    m_connect = false;
-    m_connectionState = CON_STATE_IDLE;
-    cleanUp ();
+    for (auto& association : m_readAssociations)
+    {
+        IedClientError error;
+        IedConnection_close (association.connection);
+        IedConnection_abortAsync (association.connection, &error);
+        IedConnection_destroy (association.connection);
+    }
+
+    m_readAssociations.clear ();
+}
+
+IEC61850ClientConnection::ReadAssociation*
+IEC61850ClientConnection::m_acquireReadAssociation ()
+{
+    std::lock_guard<std::mutex> lock (m_readAssociationLock);
+
+    ReadAssociation* leastLoaded = nullptr;
+
+    for (auto& association : m_readAssociations)
+    {
+        if (IedConnection_getState (association.connection)
+            != IED_STATE_CONNECTED)
+            continue;
+
+        if (!leastLoaded || association.outstanding < leastLoaded->outstanding)
+            leastLoaded = &association;
+    }
+
+    if (leastLoaded)
+        leastLoaded->outstanding++;
+
+    return leastLoaded;
 }
 
 void
-IEC61850ClientConnection::Connect ()
+IEC61850ClientConnection::m_releaseReadAssociation (
+    ReadAssociation* association)
+{
+    if (!association)
+        return;
+
+    std::lock_guard<std::mutex> lock (m_readAssociationLock);
+    association->outstanding--;
+}
+
+IedConnection
+IEC61850ClientConnection::m_readConnection ()
+{
+    ReadAssociation* association = m_acquireReadAssociation ();
+
+    if (!association)
+        return m_connection;
+
+    // synchronous reads only need the association that is least busy
+    m_releaseReadAssociation (association);
+
+    return association->connection;
+}
+
+int
+IEC61850ClientConnection::m_readWindow () const
 {
-    m_connect = true;
+    return m_config->getMaxOutstandingReads ()
+           * std::max<int> (1, (int)m_readAssociations.size ());
 }
 
 MmsVariableSpecification*
@@ -869,10 +2641,53 @@ IEC61850ClientConnection::readValue (IedClientError* error, const char* objRef,
                                      FunctionalConstraint fc)
 {
     MmsValue* value
-        = IedConnection_readObject (m_connection, error, objRef, fc);
+        = IedConnection_readObject (m_readConnection (), error, objRef, fc);
     return value;
 }
 
+MmsValue*
+IEC61850ClientConnection::readMinimal (IedClientError* error,
+                                       const DataExchangeDefinition* def,
+                                       FunctionalConstraint fc)
+{
+    std::string domainId;
+    LinkedList itemIds = LinkedList_create ();
+
+    if (!minimalReadItemIds (def, fc, domainId, itemIds))
+    {
+        LinkedList_destroyDeep (itemIds, free);
+        *error = IED_ERROR_OBJECT_REFERENCE_INVALID;
+        return nullptr;
+    }
+
+    MmsError mmsError = MMS_ERROR_NONE;
+
+    MmsValue* values = MmsConnection_readMultipleVariables (
+        IedConnection_getMmsConnection (m_readConnection ()), &mmsError,
+        domainId.c_str (), itemIds);
+
+    LinkedList_destroyDeep (itemIds, free);
+
+    *error = toIedClientError (mmsError);
+
+    return values;
+}
+
+MmsValue*
+IEC61850ClientConnection::readPollBatch (IedClientError* error,
+                                         const PollBatch* batch)
+{
+    MmsError mmsError = MMS_ERROR_NONE;
+
+    MmsValue* values = MmsConnection_readMultipleVariables (
+        IedConnection_getMmsConnection (m_readConnection ()), &mmsError,
+        batch->domainId.c_str (), batch->itemIds);
+
+    *error = toIedClientError (mmsError);
+
+    return values;
+}
+
 MmsValue*
 IEC61850ClientConnection::readDatasetValues (IedClientError* error,
                                              const char* datasetRef)
@@ -894,18 +2709,40 @@ IEC61850ClientConnection::controlActionHandler (uint32_t invokeId,
                                                 ControlActionType type,
                                                 bool success)
 {
-    if (success)
+    auto context = (CommandContext*)parameter;
+    IEC61850ClientConnection* connection = context->connection;
+
+    std::vector<FailedControl> failed;
+    ControlObjectStruct* cos;
+    uint64_t commandId;
+    IedClientError operateError = IED_ERROR_OK;
+    bool commandFailed = false;
+    bool confirmed = false;
+
     {
-        auto connectionCosPair
-            = (std::pair<IEC61850ClientConnection*, ControlObjectStruct*>*)
-                parameter;
+        std::lock_guard<std::mutex> lock (connection->m_controlLock);
 
-        ControlObjectStruct* cos = connectionCosPair->second;
+        context->responsePending = false;
+        cos = context->cos;
+        commandId = context->commandId;
 
-        IEC61850ClientConnection* connection = connectionCosPair->first;
-        switch (type)
+        // the command timed out while this response was outstanding; its
+        // context was kept for it and is only recycled now
+        if (context->expired)
+        {
+            ControlObjectClient_setCommandTerminationHandler (
+                cos->client, nullptr, nullptr);
+            connection->m_releaseCommandContext (context);
+            connection->m_dispatchControls (failed);
+        }
+        else if (!success)
+        {
+            connection->m_releaseCommandContext (context);
+            connection->m_dispatchControls (failed);
+            commandFailed = true;
+        }
+        else if (type == CONTROL_ACTION_TYPE_OPERATE)
         {
-        case CONTROL_ACTION_TYPE_OPERATE: {
             if (cos->mode == CONTROL_MODEL_SBO_ENHANCED
                 || cos->mode == CONTROL_MODEL_DIRECT_ENHANCED)
             {
@@ -913,51 +2750,224 @@ IEC61850ClientConnection::controlActionHandler (uint32_t invokeId,
             }
             else
             {
-                cos->state = CONTROL_IDLE;
+                connection->m_releaseCommandContext (context);
+                connection->m_dispatchControls (failed);
             }
-            connection->sendActCon (cos);
-            break;
+            confirmed = true;
         }
-        case CONTROL_ACTION_TYPE_SELECT: {
-            cos->state = CONTROL_SELECTED;
-            break;
+        else if (type == CONTROL_ACTION_TYPE_SELECT)
+        {
+            // operate straight from the select confirmation
+            cos->state = CONTROL_WAIT_FOR_ACT_CON;
+            context->responsePending = true;
+            ControlObjectClient_operateAsync (cos->client, &operateError,
+                                              cos->value, 0,
+                                              controlActionHandler, parameter);
+            if (operateError != IED_ERROR_OK)
+            {
+                context->responsePending = false;
+                connection->m_releaseCommandContext (context);
+                connection->m_dispatchControls (failed);
+                commandFailed = true;
+            }
         }
-        case CONTROL_ACTION_TYPE_CANCEL: {
-            break;
+    }
+
+    connection->m_reportFailedControls (failed);
+
+    if (commandFailed)
+    {
+        if (!success)
+        {
+            if (err != IED_ERROR_OK)
+                connection->m_client->logIedClientError (err, cos->label);
+            Iec61850Utility::log_error ("Control action failed for %s",
+                                        cos->label.c_str ());
         }
+        else
+        {
+            connection->m_client->logIedClientError (operateError,
+                                                     cos->label);
         }
+        connection->m_client->commandFailed (commandId, cos->label, false);
+    }
+    else if (confirmed)
+    {
+        connection->sendActCon (cos, commandId);
     }
 }
 
 void
-IEC61850ClientConnection::executePeriodicTasks ()
+IEC61850ClientConnection::m_prepareCommandContexts ()
 {
-    uint64_t currentTime = getMonotonicTimeInMs ();
-    if (m_config->getPollingInterval () > 0
-        && currentTime >= m_nextPollingTime)
+    std::lock_guard<std::mutex> lock (m_controlLock);
+
+    // an object has at most one command in flight
+    m_commandContexts.assign (m_controlObjects.size (),
+                              { this, nullptr, 0, 0, 0, false, false });
+    m_freeCommandContexts.clear ();
+    m_pendingControls.clear ();
+    m_readyControls.clear ();
+
+    for (auto& context : m_commandContexts)
+    {
+        m_freeCommandContexts.push_back (&context);
+    }
+}
+
+IEC61850ClientConnection::CommandContext*
+IEC61850ClientConnection::m_acquireCommandContext (ControlObjectStruct* cos)
+{
+    CommandContext* context = m_freeCommandContexts.back ();
+    m_freeCommandContexts.pop_back ();
+
+    context->cos = cos;
+    context->deadline = UINT64_MAX;
+    context->responsePending = false;
+    context->expired = false;
+    m_pendingControls.insert (context);
+
+    return context;
+}
+
+void
+IEC61850ClientConnection::m_releaseCommandContext (CommandContext* context)
+{
+    m_pendingControls.erase (context);
+    m_freeCommandContexts.push_back (context);
+
+    context->cos->state = CONTROL_IDLE;
+    m_controlIdle (context->cos);
+}
+
+bool
+IEC61850ClientConnection::m_completeTermination (CommandContext* context,
+                                                 ControlObjectClient client,
+                                                 ControlObjectStruct*& cos,
+                                                 uint64_t& commandId)
+{
+    std::vector<FailedControl> failed;
+
     {
-        m_client->handleAllValues ();
-        m_nextPollingTime = currentTime + m_config->getPollingInterval ();
+        std::lock_guard<std::mutex> lock (m_controlLock);
+
+        // the context may have been recycled for a command on another
+        // object or one that has not been confirmed yet
+        if (m_pendingControls.find (context) == m_pendingControls.end ()
+            || context->cos->client != client
+            || context->cos->state != CONTROL_WAIT_FOR_ACT_TERM)
+            return false;
+
+        cos = context->cos;
+        commandId = context->commandId;
+
+        m_releaseCommandContext (context);
+        m_dispatchControls (failed);
     }
 
-    for (const auto& co : m_controlObjects)
+    m_reportFailedControls (failed);
+
+    return true;
+}
+
+void
+IEC61850ClientConnection::m_expireCommandContexts (uint64_t currentTime)
+{
+    std::vector<FailedControl> failed;
+
     {
-        ControlObjectStruct* cos = co.second;
+        std::lock_guard<std::mutex> lock (m_controlLock);
 
-        auto pair = std::make_shared<
-            std::pair<IEC61850ClientConnection*, ControlObjectStruct*> > (this,
-                                                                          cos);
+        std::vector<CommandContext*> expired;
 
-        if (cos->state == CONTROL_IDLE)
-            continue;
-        else if (cos->state == CONTROL_SELECTED)
+        for (CommandContext* context : m_pendingControls)
+        {
+            if (context->deadline <= currentTime)
+                expired.push_back (context);
+        }
+
+        bool released = false;
+
+        for (CommandContext* context : expired)
         {
-            IedClientError error;
-            ControlObjectClient_operateAsync (cos->client, &error, cos->value,
-                                              0, controlActionHandler,
-                                              pair.get ());
+            // libiec61850 still holds the context as the parameter of the
+            // select or operate, it is recycled once that is answered
+            if (context->responsePending)
+            {
+                Iec61850Utility::log_warn ("No command confirmation for %s",
+                                           context->cos->label.c_str ());
+                context->expired = true;
+                context->deadline = UINT64_MAX;
+                continue;
+            }
+
+            Iec61850Utility::log_warn ("No command termination for %s",
+                                       context->cos->label.c_str ());
+
+            // a termination that still arrives must not hit a recycled
+            // context
+            ControlObjectClient_setCommandTerminationHandler (
+                context->cos->client, nullptr, nullptr);
+
+            m_releaseCommandContext (context);
+            released = true;
         }
+
+        if (released)
+            m_dispatchControls (failed);
     }
+
+    m_reportFailedControls (failed);
+}
+
+size_t
+IEC61850ClientConnection::pendingControls ()
+{
+    std::lock_guard<std::mutex> lock (m_controlLock);
+    return m_pendingControls.size ();
+}
+
+void
+IEC61850ClientConnection::executePeriodicTasks ()
+{
+    uint64_t currentTime = getMonotonicTimeInMs ();
+    for (auto& schedule : m_pollSchedules)
+    {
+        m_runPollSchedule (schedule, currentTime);
+    }
+
+    m_expireCommandContexts (currentTime);
+}
+
+void
+IEC61850ClientConnection::m_bringUp ()
+{
+    m_associatedTime = getMonotonicTimeInMs ();
+    m_openReadAssociations ();
+    m_requestModelIdentity ();
+    m_awaitReadAssociations ();
+    m_validateModelCache ();
+
+    // variable specifications are fetched in the background while control
+    // objects and datasets are set up; reports are only enabled once all of
+    // them are known
+    m_requestVarSpecs ();
+    m_initialiseControlObjects ();
+    m_prepareCommandContexts ();
+    m_configDatasets ();
+    m_planReports ();
+    m_awaitVarSpecs ();
+
+    m_firstReportPending = true;
+    m_timeToFirstReport = -1;
+    m_configRcb ();
+    m_preparePollSchedules ();
+    m_preparePollBatches ();
+    m_preparePipelinedPolling ();
+    m_saveModelCache ();
+    Iec61850Utility::log_info (
+        "Connected to %s:%d (bring-up %lu ms)", m_serverIp.c_str (), m_tcpPort,
+        (unsigned long)(getMonotonicTimeInMs () - m_associatedTime));
 }
 
 void
@@ -967,6 +2977,16 @@ IEC61850ClientConnection::_conThread ()
     {
         while (m_started)
         {
+            bool disconnect;
+            {
+                std::lock_guard<std::mutex> lock (m_conLock);
+                disconnect = m_disconnectPending;
+                m_disconnectPending = false;
+            }
+
+            if (disconnect)
+                m_closeConnection ();
+
             {
                 if (m_connect)
                 {
@@ -996,7 +3016,10 @@ IEC61850ClientConnection::_conThread ()
                                 m_delayExpirationTime
                                     = getMonotonicTimeInMs () + 10000;
                                 if (m_osiParameters)
-                                    m_setOsiConnectionParameters ();
+                                    m_setOsiConnectionParameters (
+                                        m_connection);
+                                IedConnection_installStateChangedHandler (
+                                    m_connection, stateChangedHandler, this);
                             }
 
                             IedConnection_connectAsync (m_connection, &error,
@@ -1036,44 +3059,47 @@ IEC61850ClientConnection::_conThread ()
                         newState = IedConnection_getState (m_connection);
                         if (newState == IED_STATE_CONNECTED)
                         {
+                            m_bringUp ();
+
                             {
                                 std::lock_guard<std::mutex> lock (m_conLock);
-                                m_setVarSpecs ();
-                                m_initialiseControlObjects ();
-                                m_configDatasets ();
-                                m_configRcb ();
-                                Iec61850Utility::log_info (
-                                    "Connected to %s:%d", m_serverIp.c_str (),
-                                    m_tcpPort);
-                                m_connectionState = CON_STATE_CONNECTED;
-                                m_connecting = false;
-                                m_connected = true;
+                                // a disconnect requested meanwhile is
+                                // handled on the next turn
+                                if (m_connect)
+                                {
+                                    m_connectionState = CON_STATE_CONNECTED;
+                                    m_connecting = false;
+                                    m_connected = true;
+                                }
                             }
+                            m_client->connectionStateChanged ();
                         }
                         else if (getMonotonicTimeInMs ()
                                  > m_delayExpirationTime)
                         {
-                            std::lock_guard<std::mutex> lock (m_conLock);
                             Iec61850Utility::log_warn (
                                 "Timeout while connecting %d", m_tcpPort);
-                            Disconnect ();
+                            {
+                                std::lock_guard<std::mutex> lock (m_conLock);
+                                m_connect = false;
+                            }
+                            m_closeConnection ();
                         }
                         break;
 
-                    case CON_STATE_CONNECTED: {
-                        std::lock_guard<std::mutex> lock (m_conLock);
+                    case CON_STATE_CONNECTED:
                         newState = IedConnection_getState (m_connection);
                         if (newState != IED_STATE_CONNECTED)
                         {
                             cleanUp ();
+                            std::lock_guard<std::mutex> lock (m_conLock);
                             m_connectionState = CON_STATE_IDLE;
                         }
                         else
                         {
                             executePeriodicTasks ();
                         }
-                    }
-                    break;
+                        break;
 
                     case CON_STATE_CLOSED: {
                         std::lock_guard<std::mutex> lock (m_conLock);
@@ -1098,7 +3124,7 @@ IEC61850ClientConnection::_conThread ()
                 }
             }
 
-            Thread_sleep (50);
+            m_waitForWakeUp (m_nextWakeUpTime ());
         }
         {
             std::lock_guard<std::mutex> lock (m_conLock);
@@ -1114,21 +3140,23 @@ IEC61850ClientConnection::_conThread ()
 
 void
 IEC61850ClientConnection::sendActCon (
-    const IEC61850ClientConnection::ControlObjectStruct* cos)
+    const IEC61850ClientConnection::ControlObjectStruct* cos,
+    uint64_t commandId)
 {
-    m_client->sendCommandAck (cos->label, cos->mode, false);
+    m_client->sendCommandAck (commandId, cos->label, cos->mode, false);
 }
 
 void
 IEC61850ClientConnection::sendActTerm (
-    const IEC61850ClientConnection::ControlObjectStruct* cos)
+    const IEC61850ClientConnection::ControlObjectStruct* cos,
+    uint64_t commandId)
 {
-    m_client->sendCommandAck (cos->label, cos->mode, true);
+    m_client->sendCommandAck (commandId, cos->label, cos->mode, true);
 }
 
 bool
 IEC61850ClientConnection::operate (const std::string& objRef,
-                                   DatapointValue value)
+                                   DatapointValue value, uint64_t commandId)
 {
     auto it = m_controlObjects.find (objRef);
 
@@ -1141,11 +3169,99 @@ IEC61850ClientConnection::operate (const std::string& objRef,
 
     ControlObjectStruct* co = it->second;
 
-    MmsValue* mmsValue = co->value;
+    switch (MmsValue_getType (co->value))
+    {
+    case MMS_BOOLEAN:
+    case MMS_INTEGER:
+    case MMS_BIT_STRING:
+    case MMS_FLOAT:
+        break;
+    default:
+        Iec61850Utility::log_error ("Invalid mms value type");
+        return false;
+    }
 
-    MmsType type = MmsValue_getType (mmsValue);
+    // accepted without being sent, so there is nothing to track
+    if (co->mode == CONTROL_MODEL_STATUS_ONLY)
+    {
+        m_client->commandIgnored (commandId);
+        return true;
+    }
 
-    switch (type)
+    std::vector<FailedControl> failed;
+
+    {
+        std::lock_guard<std::mutex> lock (m_controlLock);
+
+        co->queue.push_back ({ value, commandId });
+
+        if (co->state == CONTROL_IDLE)
+            m_controlIdle (co);
+
+        m_dispatchControls (failed);
+    }
+
+    m_reportFailedControls (failed);
+
+    return true;
+}
+
+void
+IEC61850ClientConnection::m_controlIdle (ControlObjectStruct* cos)
+{
+    if (cos->queue.empty () || cos->ready)
+        return;
+
+    cos->ready = true;
+    m_readyControls.push_back (cos);
+}
+
+void
+IEC61850ClientConnection::m_dispatchControls (
+    std::vector<FailedControl>& failed)
+{
+    while (!m_readyControls.empty () && !m_freeCommandContexts.empty ()
+           && (int)m_pendingControls.size ()
+                  < m_config->getMaxConcurrentCommands ())
+    {
+        ControlObjectStruct* co = m_readyControls.front ();
+        m_readyControls.pop_front ();
+        co->ready = false;
+
+        QueuedControl command = co->queue.front ();
+        co->queue.pop_front ();
+
+        // the timeout of the command starts now, unless it has already been
+        // answered while it was queued
+        if (!m_client->commandDispatched (command.commandId))
+        {
+            m_controlIdle (co);
+            continue;
+        }
+
+        if (!m_issueControl (co, command))
+            failed.push_back ({ command.commandId, co->label });
+    }
+}
+
+void
+IEC61850ClientConnection::m_reportFailedControls (
+    const std::vector<FailedControl>& failed)
+{
+    for (const auto& control : failed)
+    {
+        m_client->commandFailed (control.commandId, control.label, false);
+    }
+}
+
+bool
+IEC61850ClientConnection::m_issueControl (ControlObjectStruct* co,
+                                          QueuedControl& command)
+{
+    DatapointValue& value = command.value;
+    MmsValue* mmsValue = co->value;
+
+    switch (MmsValue_getType (mmsValue))
     {
     case MMS_BOOLEAN:
         MmsValue_setBoolean (mmsValue, value.toInt ());
@@ -1171,47 +3287,55 @@ IEC61850ClientConnection::operate (const std::string& objRef,
         MmsValue_setFloat (mmsValue, (float)value.toDouble ());
         break;
     default:
-        Iec61850Utility::log_error ("Invalid mms value type");
-        return false;
+        break;
     }
-    IedClientError error;
 
-    auto connectionControlPair
-        = new std::pair<IEC61850ClientConnection*, ControlObjectStruct*> (this,
-                                                                          co);
-    m_connControlPairs.push_back (connectionControlPair);
+    CommandContext* context = m_acquireCommandContext (co);
+    context->commandId = command.commandId;
+    context->dispatchTime = getMonotonicTimeInMs ();
+    // the command timeout runs from dispatch, as in the tracker
+    context->deadline
+        = context->dispatchTime + m_config->getCommandTimeout ();
+    context->responsePending = true;
 
     if (co->mode == CONTROL_MODEL_DIRECT_ENHANCED
         || co->mode == CONTROL_MODEL_SBO_ENHANCED)
     {
         ControlObjectClient_setCommandTerminationHandler (
-            co->client, commandTerminationHandler, connectionControlPair);
+            co->client, commandTerminationHandler, context);
     }
 
+    IedClientError error = IED_ERROR_OK;
+
     switch (co->mode)
     {
     case CONTROL_MODEL_DIRECT_ENHANCED:
     case CONTROL_MODEL_DIRECT_NORMAL:
         co->state = CONTROL_WAIT_FOR_ACT_CON;
         ControlObjectClient_operateAsync (co->client, &error, mmsValue, 0,
-                                          controlActionHandler,
-                                          connectionControlPair);
+                                          controlActionHandler, context);
         break;
     case CONTROL_MODEL_SBO_NORMAL:
         co->state = CONTROL_WAIT_FOR_SELECT;
-        ControlObjectClient_selectAsync (
-            co->client, &error, controlActionHandler, connectionControlPair);
+        ControlObjectClient_selectAsync (co->client, &error,
+                                         controlActionHandler, context);
         break;
     case CONTROL_MODEL_SBO_ENHANCED:
         co->state = CONTROL_WAIT_FOR_SELECT_WITH_VALUE;
-        ControlObjectClient_selectWithValueAsync (co->client, &error, mmsValue,
-                                                  controlActionHandler,
-                                                  connectionControlPair);
+        ControlObjectClient_selectWithValueAsync (
+            co->client, &error, mmsValue, controlActionHandler, context);
         break;
     case CONTROL_MODEL_STATUS_ONLY:
         break;
     }
 
+    if (error != IED_ERROR_OK)
+    {
+        m_client->logIedClientError (error, "Operate " + co->label);
+        m_releaseCommandContext (context);
+        return false;
+    }
+
     return true;
 }
 
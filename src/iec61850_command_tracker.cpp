@@ -0,0 +1,245 @@
+#include "iec61850_command_tracker.hpp"
+#include <algorithm>
+
+CommandTimerWheel::CommandTimerWheel (uint64_t currentTick)
+    : m_currentTick (currentTick)
+{
+    for (auto& level : m_slots)
+    {
+        level.resize (WHEEL_SLOTS);
+    }
+}
+
+void
+CommandTimerWheel::m_insert (TrackedCommand* command, uint64_t earliestTick)
+{
+    static const uint64_t maxDelta
+        = (1ULL << (WHEEL_BITS * WHEEL_LEVELS)) - 1;
+
+    uint64_t tick = std::max (command->expiryTick, earliestTick);
+    uint64_t delta = tick - m_currentTick;
+
+    // beyond the range of the wheel: park in the last slot reachable and
+    // schedule again from there when it is cascaded
+    if (delta > maxDelta)
+    {
+        tick = m_currentTick + maxDelta;
+        delta = maxDelta;
+    }
+
+    int level = 0;
+    while ((delta >> (WHEEL_BITS * (level + 1))) != 0)
+        level++;
+
+    size_t slot = (tick >> (WHEEL_BITS * level)) & (WHEEL_SLOTS - 1);
+
+    std::list<TrackedCommand*>& commands = m_slots[level][slot];
+
+    command->level = level;
+    command->slot = slot;
+    command->position = commands.insert (commands.end (), command);
+}
+
+void
+CommandTimerWheel::schedule (TrackedCommand* command)
+{
+    // the slot of the current tick has already been expired
+    m_insert (command, m_currentTick + 1);
+    m_size++;
+}
+
+void
+CommandTimerWheel::cancel (TrackedCommand* command)
+{
+    m_slots[command->level][command->slot].erase (command->position);
+    m_size--;
+}
+
+void
+CommandTimerWheel::m_cascade (int level)
+{
+    size_t slot
+        = (m_currentTick >> (WHEEL_BITS * level)) & (WHEEL_SLOTS - 1);
+
+    std::list<TrackedCommand*> commands;
+    commands.swap (m_slots[level][slot]);
+
+    for (TrackedCommand* command : commands)
+    {
+        m_insert (command, m_currentTick);
+    }
+}
+
+void
+CommandTimerWheel::advance (uint64_t tick,
+                            std::vector<TrackedCommand*>& expired)
+{
+    while (m_currentTick < tick)
+    {
+        if (m_size == 0)
+        {
+            m_currentTick = tick;
+            break;
+        }
+
+        m_currentTick++;
+
+        for (int level = WHEEL_LEVELS - 1; level > 0; level--)
+        {
+            uint64_t lowerBits = (1ULL << (WHEEL_BITS * level)) - 1;
+
+            if ((m_currentTick & lowerBits) == 0)
+                m_cascade (level);
+        }
+
+        std::list<TrackedCommand*>& commands
+            = m_slots[0][m_currentTick & (WHEEL_SLOTS - 1)];
+
+        expired.insert (expired.end (), commands.begin (), commands.end ());
+        m_size -= commands.size ();
+        commands.clear ();
+    }
+}
+
+IEC61850CommandTracker::IEC61850CommandTracker (uint64_t tickMs,
+                                                uint64_t currentTime)
+    : m_tickMs (tickMs), m_wheel (currentTime / tickMs)
+{
+}
+
+uint64_t
+IEC61850CommandTracker::add (const std::string& label, Datapoint* operation)
+{
+    std::lock_guard<std::mutex> lock (m_lock);
+
+    std::unique_ptr<TrackedCommand> command (new TrackedCommand ());
+    command->id = m_nextId++;
+    command->label = label;
+    command->operation.reset (operation);
+    command->confirmed = false;
+    command->scheduled = false;
+
+    uint64_t id = command->id;
+    m_commands[id] = std::move (command);
+
+    return id;
+}
+
+uint64_t
+IEC61850CommandTracker::add (const std::string& label, Datapoint* operation,
+                             uint64_t timeout, uint64_t currentTime)
+{
+    uint64_t id = add (label, operation);
+
+    schedule (id, timeout, currentTime);
+
+    return id;
+}
+
+bool
+IEC61850CommandTracker::schedule (uint64_t id, uint64_t timeout,
+                                  uint64_t currentTime)
+{
+    std::lock_guard<std::mutex> lock (m_lock);
+
+    auto it = m_commands.find (id);
+    if (it == m_commands.end ())
+        return false;
+
+    if (!it->second->scheduled)
+        m_schedule (it->second.get (), timeout, currentTime);
+
+    return true;
+}
+
+void
+IEC61850CommandTracker::m_schedule (TrackedCommand* command, uint64_t timeout,
+                                    uint64_t currentTime)
+{
+    // an idle wheel is not advanced, catch up before scheduling on it
+    if (m_wheel.size () == 0)
+    {
+        std::vector<TrackedCommand*> none;
+        m_wheel.advance (currentTime / m_tickMs, none);
+    }
+
+    command->expiryTick = (currentTime + timeout + m_tickMs - 1) / m_tickMs;
+    command->scheduled = true;
+
+    m_wheel.schedule (command);
+}
+
+void
+IEC61850CommandTracker::m_erase (CommandMap::iterator it)
+{
+    if (it->second->scheduled)
+        m_wheel.cancel (it->second.get ());
+
+    m_commands.erase (it);
+}
+
+std::shared_ptr<Datapoint>
+IEC61850CommandTracker::acknowledge (uint64_t id, bool complete)
+{
+    std::lock_guard<std::mutex> lock (m_lock);
+
+    auto it = m_commands.find (id);
+    if (it == m_commands.end ())
+        return nullptr;
+
+    std::shared_ptr<Datapoint> operation = it->second->operation;
+
+    if (complete)
+    {
+        m_erase (it);
+    }
+    else
+    {
+        it->second->confirmed = true;
+    }
+
+    return operation;
+}
+
+void
+IEC61850CommandTracker::remove (uint64_t id)
+{
+    std::lock_guard<std::mutex> lock (m_lock);
+
+    auto it = m_commands.find (id);
+    if (it == m_commands.end ())
+        return;
+
+    m_erase (it);
+}
+
+void
+IEC61850CommandTracker::expire (
+    uint64_t currentTime, std::vector<std::unique_ptr<TrackedCommand> >& expired)
+{
+    std::lock_guard<std::mutex> lock (m_lock);
+
+    std::vector<TrackedCommand*> due;
+    m_wheel.advance (currentTime / m_tickMs, due);
+
+    for (TrackedCommand* command : due)
+    {
+        auto it = m_commands.find (command->id);
+        expired.push_back (std::move (it->second));
+        m_commands.erase (it);
+    }
+}
+
+size_t
+IEC61850CommandTracker::size ()
+{
+    std::lock_guard<std::mutex> lock (m_lock);
+    return m_commands.size ();
+}
+
+size_t
+IEC61850CommandTracker::scheduled ()
+{
+    std::lock_guard<std::mutex> lock (m_lock);
+    return m_wheel.size ();
+}
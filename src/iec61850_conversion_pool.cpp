@@ -0,0 +1,108 @@
+#include "iec61850_conversion_pool.hpp"
+#include <functional>
+#include <iec61850.hpp>
+
+IEC61850ConversionPool::IEC61850ConversionPool (IEC61850Client* client,
+                                                int workerCount)
+    : m_client (client)
+{
+    for (int i = 0; i < workerCount; i++)
+    {
+        auto worker = new Worker;
+        m_workers.push_back (worker);
+    }
+
+    for (auto worker : m_workers)
+    {
+        worker->thread = new std::thread (
+            &IEC61850ConversionPool::_workerThread, this, worker);
+    }
+
+    Iec61850Utility::log_info ("Started %d conversion workers", workerCount);
+}
+
+IEC61850ConversionPool::~IEC61850ConversionPool ()
+{
+    for (auto worker : m_workers)
+    {
+        std::lock_guard<std::mutex> lock (worker->lock);
+        m_running = false;
+        worker->available.notify_one ();
+        worker->idle.notify_all ();
+    }
+
+    for (auto worker : m_workers)
+    {
+        worker->thread->join ();
+        delete worker->thread;
+
+        for (auto& task : worker->tasks)
+        {
+            if (task.value)
+                MmsValue_delete (task.value);
+        }
+
+        delete worker;
+    }
+
+    m_workers.clear ();
+}
+
+void
+IEC61850ConversionPool::submit (ConversionTask&& task)
+{
+    size_t shard = task.def->handle % m_workers.size ();
+    Worker* worker = m_workers[shard];
+
+    {
+        std::lock_guard<std::mutex> lock (worker->lock);
+        worker->tasks.push_back (std::move (task));
+    }
+
+    worker->available.notify_one ();
+}
+
+void
+IEC61850ConversionPool::drain ()
+{
+    for (auto worker : m_workers)
+    {
+        std::unique_lock<std::mutex> lock (worker->lock);
+
+        worker->idle.wait (lock, [this, worker] {
+            return !m_running || (worker->tasks.empty () && !worker->busy);
+        });
+    }
+}
+
+void
+IEC61850ConversionPool::_workerThread (Worker* worker)
+{
+    std::unique_lock<std::mutex> lock (worker->lock);
+
+    while (true)
+    {
+        worker->available.wait (lock, [this, worker] {
+            return !m_running || !worker->tasks.empty ();
+        });
+
+        if (!m_running)
+            break;
+
+        ConversionTask task = std::move (worker->tasks.front ());
+        worker->tasks.pop_front ();
+        worker->busy = true;
+
+        lock.unlock ();
+
+        m_client->convertAndSend (task.def, task.value, task.attribute,
+                                  task.fc, task.timestamp, task.polled);
+        MmsValue_delete (task.value);
+
+        lock.lock ();
+
+        worker->busy = false;
+        if (worker->tasks.empty ())
+            worker->idle.notify_all ();
+    }
+}
@@ -0,0 +1,462 @@
+#include "iec61850_model_cache.hpp"
+#include "iec61850_utility.hpp"
+#include "rapidjson/stringbuffer.h"
+#include "rapidjson/writer.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <libiec61850/mms_type_spec.h>
+#include <sstream>
+
+#define JSON_CACHE_IDENTITY "identity"
+#define JSON_CACHE_SPECS "specs"
+#define JSON_CACHE_CONTROLS "controls"
+#define JSON_CACHE_DATASETS "datasets"
+#define JSON_SPEC_NAME "n"
+#define JSON_SPEC_TYPE "t"
+#define JSON_SPEC_SIZE "s"
+#define JSON_SPEC_EXPONENT "w"
+#define JSON_SPEC_CHILDREN "c"
+#define JSON_SPEC_ELEMENT "a"
+
+using namespace rapidjson;
+
+IEC61850ModelCache::IEC61850ModelCache (const std::string& directory,
+                                        const std::string& ip, int port)
+    : m_path (directory + "/iec61850_model_" + ip + "_"
+              + std::to_string (port) + ".json")
+{
+}
+
+IEC61850ModelCache::~IEC61850ModelCache () { m_clear (); }
+
+void
+IEC61850ModelCache::m_clear ()
+{
+    for (const auto& entry : m_specs)
+        MmsVariableSpecification_destroy (entry.second);
+
+    m_specs.clear ();
+    m_controlModels.clear ();
+    m_dataSets.clear ();
+}
+
+std::string
+IEC61850ModelCache::m_specKey (const std::string& objRef,
+                               FunctionalConstraint fc)
+{
+    return objRef + "[" + std::to_string ((int)fc) + "]";
+}
+
+MmsVariableSpecification*
+IEC61850ModelCache::copySpec (MmsVariableSpecification* spec)
+{
+    if (!spec)
+        return nullptr;
+
+    auto copy = (MmsVariableSpecification*)calloc (
+        1, sizeof (MmsVariableSpecification));
+
+    *copy = *spec;
+
+    if (spec->name)
+        copy->name = strdup (spec->name);
+
+    if (spec->type == MMS_STRUCTURE)
+    {
+        int count = spec->typeSpec.structure.elementCount;
+        copy->typeSpec.structure.elements = (MmsVariableSpecification**)calloc (
+            count > 0 ? count : 1, sizeof (MmsVariableSpecification*));
+        for (int i = 0; i < count; i++)
+        {
+            copy->typeSpec.structure.elements[i]
+                = copySpec (spec->typeSpec.structure.elements[i]);
+        }
+    }
+    else if (spec->type == MMS_ARRAY)
+    {
+        copy->typeSpec.array.elementTypeSpec
+            = copySpec (spec->typeSpec.array.elementTypeSpec);
+    }
+
+    return copy;
+}
+
+MmsVariableSpecification*
+IEC61850ModelCache::m_parseSpec (const Value& value)
+{
+    if (!value.IsObject () || !value.HasMember (JSON_SPEC_TYPE)
+        || !value[JSON_SPEC_TYPE].IsInt () || !value.HasMember (JSON_SPEC_SIZE)
+        || !value[JSON_SPEC_SIZE].IsInt ())
+        return nullptr;
+
+    auto spec = (MmsVariableSpecification*)calloc (
+        1, sizeof (MmsVariableSpecification));
+
+    spec->type = (MmsType)value[JSON_SPEC_TYPE].GetInt ();
+    int size = value[JSON_SPEC_SIZE].GetInt ();
+
+    if (value.HasMember (JSON_SPEC_NAME) && value[JSON_SPEC_NAME].IsString ())
+        spec->name = strdup (value[JSON_SPEC_NAME].GetString ());
+
+    bool valid = true;
+
+    switch (spec->type)
+    {
+    case MMS_STRUCTURE: {
+        if (!value.HasMember (JSON_SPEC_CHILDREN)
+            || !value[JSON_SPEC_CHILDREN].IsArray ())
+        {
+            valid = false;
+            break;
+        }
+        const Value& children = value[JSON_SPEC_CHILDREN];
+        int count = (int)children.Size ();
+        spec->typeSpec.structure.elements
+            = (MmsVariableSpecification**)calloc (
+                count > 0 ? count : 1, sizeof (MmsVariableSpecification*));
+        spec->typeSpec.structure.elementCount = count;
+        for (int i = 0; i < count && valid; i++)
+        {
+            spec->typeSpec.structure.elements[i]
+                = m_parseSpec (children[(unsigned)i]);
+            valid = spec->typeSpec.structure.elements[i] != nullptr;
+        }
+        break;
+    }
+    case MMS_ARRAY: {
+        spec->typeSpec.array.elementCount = size;
+        if (value.HasMember (JSON_SPEC_ELEMENT))
+            spec->typeSpec.array.elementTypeSpec
+                = m_parseSpec (value[JSON_SPEC_ELEMENT]);
+        valid = spec->typeSpec.array.elementTypeSpec != nullptr;
+        break;
+    }
+    case MMS_INTEGER:
+        spec->typeSpec.integer = size;
+        break;
+    case MMS_UNSIGNED:
+        spec->typeSpec.unsignedInteger = size;
+        break;
+    case MMS_FLOAT:
+        spec->typeSpec.floatingpoint.formatWidth = (uint8_t)size;
+        if (value.HasMember (JSON_SPEC_EXPONENT)
+            && value[JSON_SPEC_EXPONENT].IsInt ())
+            spec->typeSpec.floatingpoint.exponentWidth
+                = (uint8_t)value[JSON_SPEC_EXPONENT].GetInt ();
+        break;
+    case MMS_BIT_STRING:
+        spec->typeSpec.bitString = size;
+        break;
+    case MMS_OCTET_STRING:
+        spec->typeSpec.octetString = size;
+        break;
+    case MMS_VISIBLE_STRING:
+        spec->typeSpec.visibleString = size;
+        break;
+    case MMS_STRING:
+        spec->typeSpec.mmsString = size;
+        break;
+    case MMS_UTC_TIME:
+        spec->typeSpec.utctime = size;
+        break;
+    case MMS_BINARY_TIME:
+        spec->typeSpec.binaryTime = size;
+        break;
+    default:
+        break;
+    }
+
+    if (!valid)
+    {
+        MmsVariableSpecification_destroy (spec);
+        return nullptr;
+    }
+
+    return spec;
+}
+
+static void
+writeSpec (Writer<StringBuffer>& writer, MmsVariableSpecification* spec)
+{
+    MmsType type = MmsVariableSpecification_getType (spec);
+    const char* name = MmsVariableSpecification_getName (spec);
+
+    writer.StartObject ();
+
+    if (name)
+    {
+        writer.Key (JSON_SPEC_NAME);
+        writer.String (name);
+    }
+
+    writer.Key (JSON_SPEC_TYPE);
+    writer.Int ((int)type);
+    writer.Key (JSON_SPEC_SIZE);
+    writer.Int (MmsVariableSpecification_getSize (spec));
+
+    if (type == MMS_FLOAT)
+    {
+        writer.Key (JSON_SPEC_EXPONENT);
+        writer.Int (MmsVariableSpecification_getExponentWidth (spec));
+    }
+    else if (type == MMS_STRUCTURE)
+    {
+        writer.Key (JSON_SPEC_CHILDREN);
+        writer.StartArray ();
+        int count = MmsVariableSpecification_getSize (spec);
+        for (int i = 0; i < count; i++)
+        {
+            writeSpec (writer,
+                       MmsVariableSpecification_getChildSpecificationByIndex (
+                           spec, i));
+        }
+        writer.EndArray ();
+    }
+    else if (type == MMS_ARRAY)
+    {
+        writer.Key (JSON_SPEC_ELEMENT);
+        writeSpec (writer,
+                   MmsVariableSpecification_getArrayElementSpecification (spec));
+    }
+
+    writer.EndObject ();
+}
+
+void
+IEC61850ModelCache::m_load ()
+{
+    m_loaded = true;
+
+    std::ifstream file (m_path);
+
+    if (!file.is_open ())
+    {
+        Iec61850Utility::log_info ("No model cache %s", m_path.c_str ());
+        return;
+    }
+
+    std::stringstream content;
+    content << file.rdbuf ();
+
+    Document document;
+
+    if (document.Parse (content.str ().c_str ()).HasParseError ()
+        || !document.IsObject () || !document.HasMember (JSON_CACHE_IDENTITY)
+        || !document[JSON_CACHE_IDENTITY].IsString ())
+    {
+        Iec61850Utility::log_warn ("Invalid model cache %s -> ignored",
+                                   m_path.c_str ());
+        return;
+    }
+
+    m_identity = document[JSON_CACHE_IDENTITY].GetString ();
+
+    if (document.HasMember (JSON_CACHE_SPECS)
+        && document[JSON_CACHE_SPECS].IsObject ())
+    {
+        const Value& specs = document[JSON_CACHE_SPECS];
+        for (auto it = specs.MemberBegin (); it != specs.MemberEnd (); ++it)
+        {
+            MmsVariableSpecification* spec = m_parseSpec (it->value);
+            if (spec)
+                m_specs[it->name.GetString ()] = spec;
+        }
+    }
+
+    if (document.HasMember (JSON_CACHE_CONTROLS)
+        && document[JSON_CACHE_CONTROLS].IsObject ())
+    {
+        const Value& controls = document[JSON_CACHE_CONTROLS];
+        for (auto it = controls.MemberBegin (); it != controls.MemberEnd ();
+             ++it)
+        {
+            if (it->value.IsInt ())
+                m_controlModels[it->name.GetString ()] = it->value.GetInt ();
+        }
+    }
+
+    if (document.HasMember (JSON_CACHE_DATASETS)
+        && document[JSON_CACHE_DATASETS].IsObject ())
+    {
+        const Value& dataSets = document[JSON_CACHE_DATASETS];
+        for (auto it = dataSets.MemberBegin (); it != dataSets.MemberEnd ();
+             ++it)
+        {
+            if (!it->value.IsArray ())
+                continue;
+
+            std::vector<std::string>& entries
+                = m_dataSets[it->name.GetString ()];
+            for (const Value& entry : it->value.GetArray ())
+            {
+                if (entry.IsString ())
+                    entries.push_back (entry.GetString ());
+            }
+        }
+    }
+}
+
+bool
+IEC61850ModelCache::validate (const std::string& identity)
+{
+    if (!m_loaded)
+        m_load ();
+
+    if (identity.empty ())
+        return false;
+
+    if (identity == m_identity)
+        return true;
+
+    if (!m_identity.empty ())
+    {
+        Iec61850Utility::log_info ("Model identity changed, drop cache %s",
+                                   m_path.c_str ());
+    }
+
+    m_clear ();
+    m_identity = identity;
+    m_dirty = true;
+
+    return true;
+}
+
+bool
+IEC61850ModelCache::save ()
+{
+    StringBuffer buffer;
+    Writer<StringBuffer> writer (buffer);
+
+    writer.StartObject ();
+    writer.Key (JSON_CACHE_IDENTITY);
+    writer.String (m_identity.c_str ());
+
+    writer.Key (JSON_CACHE_SPECS);
+    writer.StartObject ();
+    for (const auto& entry : m_specs)
+    {
+        writer.Key (entry.first.c_str ());
+        writeSpec (writer, entry.second);
+    }
+    writer.EndObject ();
+
+    writer.Key (JSON_CACHE_CONTROLS);
+    writer.StartObject ();
+    for (const auto& entry : m_controlModels)
+    {
+        writer.Key (entry.first.c_str ());
+        writer.Int (entry.second);
+    }
+    writer.EndObject ();
+
+    writer.Key (JSON_CACHE_DATASETS);
+    writer.StartObject ();
+    for (const auto& entry : m_dataSets)
+    {
+        writer.Key (entry.first.c_str ());
+        writer.StartArray ();
+        for (const auto& member : entry.second)
+            writer.String (member.c_str ());
+        writer.EndArray ();
+    }
+    writer.EndObject ();
+
+    writer.EndObject ();
+
+    // replace the cache atomically so that a crash never leaves half a file
+    std::string tmpPath = m_path + ".tmp";
+    {
+        std::ofstream file (tmpPath, std::ios::trunc);
+        if (!file.is_open () || !(file << buffer.GetString ()))
+        {
+            Iec61850Utility::log_warn ("Failed to write model cache %s",
+                                       tmpPath.c_str ());
+            return false;
+        }
+    }
+
+    if (std::rename (tmpPath.c_str (), m_path.c_str ()) != 0)
+    {
+        Iec61850Utility::log_warn ("Failed to replace model cache %s",
+                                   m_path.c_str ());
+        std::remove (tmpPath.c_str ());
+        return false;
+    }
+
+    m_dirty = false;
+
+    return true;
+}
+
+MmsVariableSpecification*
+IEC61850ModelCache::getSpec (const std::string& objRef,
+                             FunctionalConstraint fc) const
+{
+    auto it = m_specs.find (m_specKey (objRef, fc));
+
+    return it == m_specs.end () ? nullptr : copySpec (it->second);
+}
+
+void
+IEC61850ModelCache::putSpec (const std::string& objRef,
+                             FunctionalConstraint fc,
+                             MmsVariableSpecification* spec)
+{
+    if (!spec)
+        return;
+
+    std::string key = m_specKey (objRef, fc);
+
+    auto it = m_specs.find (key);
+    if (it != m_specs.end ())
+        MmsVariableSpecification_destroy (it->second);
+
+    m_specs[key] = copySpec (spec);
+    m_dirty = true;
+}
+
+bool
+IEC61850ModelCache::getControlModel (const std::string& objRef,
+                                     ControlModel& mode) const
+{
+    auto it = m_controlModels.find (objRef);
+
+    if (it == m_controlModels.end ())
+        return false;
+
+    mode = (ControlModel)it->second;
+
+    return true;
+}
+
+void
+IEC61850ModelCache::putControlModel (const std::string& objRef,
+                                     ControlModel mode)
+{
+    m_controlModels[objRef] = (int)mode;
+    m_dirty = true;
+}
+
+bool
+IEC61850ModelCache::getDataSetDirectory (
+    const std::string& dataSetRef, std::vector<std::string>& entries) const
+{
+    auto it = m_dataSets.find (dataSetRef);
+
+    if (it == m_dataSets.end ())
+        return false;
+
+    entries = it->second;
+
+    return true;
+}
+
+void
+IEC61850ModelCache::putDataSetDirectory (
+    const std::string& dataSetRef, const std::vector<std::string>& entries)
+{
+    m_dataSets[dataSetRef] = entries;
+    m_dirty = true;
+}
@@ -0,0 +1,108 @@
+#include "iec61850_report_planner.hpp"
+#include <algorithm>
+#include <map>
+
+std::string
+IEC61850ReportPlanner::datasetRef (const std::string& ldName,
+                                   FunctionalConstraint fc, size_t offset)
+{
+    return ldName + "/LLN0.Fledge" + FunctionalConstraint_toString (fc)
+           + std::to_string (offset);
+}
+
+PlannedDataset
+IEC61850ReportPlanner::m_createDataset (
+    const std::string& ldName, FunctionalConstraint fc, size_t offset,
+    std::vector<DataExchangeDefinition*>::const_iterator first,
+    std::vector<DataExchangeDefinition*>::const_iterator last)
+{
+    PlannedDataset planned;
+    planned.ldName = ldName;
+    planned.fc = fc;
+    planned.offset = offset;
+    planned.definitions.assign (first, last);
+
+    planned.dataset = std::make_shared<Dataset> ();
+    planned.dataset->datasetRef = datasetRef (ldName, fc, offset);
+    planned.dataset->dynamic = true;
+
+    for (const auto& def : planned.definitions)
+    {
+        planned.dataset->entries.push_back (
+            def->objRef + "[" + FunctionalConstraint_toString (fc) + "]");
+    }
+
+    return planned;
+}
+
+std::vector<PlannedDataset>
+IEC61850ReportPlanner::plan (
+    const std::unordered_map<std::string, DataExchangeDefinition*>&
+        definitions,
+    size_t maxEntries)
+{
+    std::map<std::pair<std::string, FunctionalConstraint>,
+             std::vector<DataExchangeDefinition*> >
+        groups;
+
+    for (const auto& entry : definitions)
+    {
+        DataExchangeDefinition* def = entry.second;
+        size_t slashPos = def->objRef.find ('/');
+
+        if (slashPos == std::string::npos)
+            continue;
+
+        FunctionalConstraint fc = def->cdcType == MV || def->cdcType == APC
+                                      ? IEC61850_FC_MX
+                                      : IEC61850_FC_ST;
+
+        groups[{ def->objRef.substr (0, slashPos), fc }].push_back (def);
+    }
+
+    std::vector<PlannedDataset> planned;
+
+    if (maxEntries == 0)
+        return planned;
+
+    for (auto& group : groups)
+    {
+        std::vector<DataExchangeDefinition*>& defs = group.second;
+
+        std::sort (defs.begin (), defs.end (),
+                   [] (const DataExchangeDefinition* a,
+                       const DataExchangeDefinition* b) {
+                       return a->objRef < b->objRef;
+                   });
+
+        for (size_t offset = 0; offset < defs.size (); offset += maxEntries)
+        {
+            size_t end = std::min (offset + maxEntries, defs.size ());
+            planned.push_back (m_createDataset (
+                group.first.first, group.first.second, offset,
+                defs.begin () + offset, defs.begin () + end));
+        }
+    }
+
+    return planned;
+}
+
+bool
+IEC61850ReportPlanner::split (const PlannedDataset& planned,
+                              PlannedDataset& first, PlannedDataset& second)
+{
+    size_t size = planned.definitions.size ();
+
+    if (size < 2)
+        return false;
+
+    auto middle = planned.definitions.begin () + size / 2;
+
+    first = m_createDataset (planned.ldName, planned.fc, planned.offset,
+                             planned.definitions.begin (), middle);
+    second = m_createDataset (planned.ldName, planned.fc,
+                              planned.offset + size / 2, middle,
+                              planned.definitions.end ());
+
+    return true;
+}
@@ -0,0 +1,110 @@
+#include "iec61850_spec_cache.hpp"
+#include <libiec61850/mms_type_spec.h>
+
+MmsSpecCache::~MmsSpecCache () { clear (); }
+
+void
+MmsSpecCache::m_appendSignature (MmsVariableSpecification* spec,
+                                 std::string& signature, bool root)
+{
+    MmsType type = MmsVariableSpecification_getType (spec);
+
+    // the root name is the name of the data object, not part of its type
+    if (!root)
+    {
+        const char* name = MmsVariableSpecification_getName (spec);
+        signature += name ? name : "";
+    }
+
+    signature += ':';
+    signature += std::to_string ((int)type);
+    signature += ':';
+    signature += std::to_string (MmsVariableSpecification_getSize (spec));
+
+    switch (type)
+    {
+    case MMS_STRUCTURE: {
+        int count = MmsVariableSpecification_getSize (spec);
+        signature += '{';
+        for (int i = 0; i < count; i++)
+        {
+            m_appendSignature (
+                MmsVariableSpecification_getChildSpecificationByIndex (spec,
+                                                                       i),
+                signature, false);
+            signature += ';';
+        }
+        signature += '}';
+        break;
+    }
+    case MMS_ARRAY: {
+        signature += '[';
+        m_appendSignature (
+            MmsVariableSpecification_getArrayElementSpecification (spec),
+            signature, false);
+        signature += ']';
+        break;
+    }
+    case MMS_FLOAT: {
+        signature += ':';
+        signature += std::to_string (
+            MmsVariableSpecification_getExponentWidth (spec));
+        break;
+    }
+    default:
+        break;
+    }
+}
+
+std::string
+MmsSpecCache::signature (MmsVariableSpecification* spec)
+{
+    std::string signature;
+
+    if (spec)
+        m_appendSignature (spec, signature, true);
+
+    return signature;
+}
+
+MmsVariableSpecification*
+MmsSpecCache::intern (MmsVariableSpecification* spec)
+{
+    if (!spec)
+        return nullptr;
+
+    std::string key = signature (spec);
+
+    std::lock_guard<std::mutex> lock (m_lock);
+
+    auto it = m_specs.find (key);
+
+    if (it != m_specs.end ())
+    {
+        if (it->second != spec)
+            MmsVariableSpecification_destroy (spec);
+        return it->second;
+    }
+
+    m_specs.insert ({ key, spec });
+
+    return spec;
+}
+
+void
+MmsSpecCache::clear ()
+{
+    std::lock_guard<std::mutex> lock (m_lock);
+
+    for (const auto& entry : m_specs)
+        MmsVariableSpecification_destroy (entry.second);
+
+    m_specs.clear ();
+}
+
+size_t
+MmsSpecCache::size ()
+{
+    std::lock_guard<std::mutex> lock (m_lock);
+    return m_specs.size ();
+}
@@ -0,0 +1,142 @@
+#include <gtest/gtest.h>
+#include <iec61850.hpp>
+#include <plugin_api.h>
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <string>
+
+using namespace std;
+
+// heap allocations are only counted inside countAllocationsOf ()
+static atomic<bool> countAllocations(false);
+static atomic<size_t> allocations(0);
+
+void* operator new(size_t size) {
+    if (countAllocations) allocations++;
+
+    void* p = malloc(size ? size : 1);
+
+    if (!p) throw bad_alloc();
+
+    return p;
+}
+
+void operator delete(void* p) noexcept { free(p); }
+
+void operator delete(void* p, size_t) noexcept { free(p); }
+
+// replacing a string value of the template copy costs the temporary
+// DatapointValue and the assigned copy
+static const size_t VALUE_PATCH_ALLOCATIONS = 2;
+
+static string exchanged_data = QUOTE({
+ "exchanged_data": {
+  "datapoints": [
+   {
+    "pivot_id": "TS1",
+    "label": "TS1",
+    "protocols": [
+     {
+      "name": "iec61850",
+      "objref": "TEMPLATELD1/GGIO1.Ind1",
+      "cdc": "SpsTyp"
+     }
+    ]
+   },
+   {
+    "pivot_id": "TS2",
+    "label": "TS2",
+    "protocols": [
+     {
+      "name": "iec61850",
+      "objref": "TEMPLATELD1/GGIO1.Ind2",
+      "cdc": "DpsTyp"
+     }
+    ]
+   },
+   {
+    "pivot_id": "TM1",
+    "label": "TM1",
+    "protocols": [
+     {
+      "name": "iec61850",
+      "objref": "TEMPLATELD1/GGIO1.AnIn1",
+      "cdc": "MvTyp"
+     }
+    ]
+   }
+  ]
+ }
+});
+
+template <class F>
+static size_t countAllocationsOf(F build, Datapoint*& reading) {
+    allocations = 0;
+    countAllocations = true;
+    reading = build();
+    countAllocations = false;
+    return allocations;
+}
+
+class PivotAllocationTest : public testing::Test {
+   protected:
+    void SetUp() {
+        config = new IEC61850ClientConfig();
+        config->importExchangeConfig(exchanged_data);
+        client = new IEC61850Client(nullptr, config);
+    }
+
+    void TearDown() {
+        delete client;
+        delete config;
+    }
+
+    // The reading owns its tree, so one copy of every node is the least a
+    // reading can cost. Converting the value must not take more than copying
+    // the resulting reading once, plus the replaced value.
+    void expectWithinBudget(const string& label, MmsValue* value,
+                            const string& attribute) {
+        auto def = config->getExchangeDefinitionByLabel(label);
+        ASSERT_NE(def, nullptr);
+        ASSERT_NE(def->converter, nullptr);
+
+        Datapoint* converted = nullptr;
+        Datapoint* copy = nullptr;
+
+        size_t convertedAllocations = countAllocationsOf(
+            [&]() {
+                return def->converter(*def, value, attribute,
+                                      QUALITY_VALIDITY_GOOD, 1000);
+            },
+            converted);
+        ASSERT_NE(converted, nullptr);
+
+        size_t copyAllocations = countAllocationsOf(
+            [&]() { return new Datapoint(*converted); }, copy);
+
+        RecordProperty(label + "_converted", (int)convertedAllocations);
+        RecordProperty(label + "_tree_copy", (int)copyAllocations);
+        EXPECT_LE(convertedAllocations,
+                  copyAllocations + VALUE_PATCH_ALLOCATIONS);
+
+        delete converted;
+        delete copy;
+        MmsValue_delete(value);
+    }
+
+    IEC61850ClientConfig* config = nullptr;
+    IEC61850Client* client = nullptr;
+};
+
+TEST_F(PivotAllocationTest, SingleTreeCopyPerReading) {
+    expectWithinBudget("TS1", MmsValue_newBoolean(true), "stVal");
+    expectWithinBudget("TS2", MmsValue_newIntegerFromInt32(2), "stVal");
+
+    config->getExchangeDefinitionByLabel("TM1")->elements.valueF = 0;
+    MmsValue* mag = MmsValue_createEmptyArray(1);
+    MmsValue_setElement(mag, 0, MmsValue_newFloat(1.5f));
+
+    expectWithinBudget("TM1", mag, "mag");
+}
@@ -55,6 +55,19 @@ static string protocol_config_2 = QUOTE ({
     }
 });
 
+static string protocol_config_associations = QUOTE ({
+    "protocol_stack" : {
+        "name" : "iec61850client",
+        "version" : "0.0.1",
+        "transport_layer" : {
+            "ied_name" : "IED1",
+            "connections" :
+                [ { "ip_addr" : "127.0.0.1", "port" : 10002, "tls" : false } ]
+        },
+        "application_layer" : { "polling_interval" : 0, "associations" : 3 }
+    }
+});
+
 // PLUGIN DEFAULT EXCHANGED DATA CONF
 
 static string exchanged_data
@@ -511,3 +524,163 @@ TEST_F (ConnectionHandlingTest, TwoConnectionsBackup)
     IedModel_destroy (model1);
     IedModel_destroy (model2);
 }
+
+TEST_F (ConnectionHandlingTest, ReadAssociations)
+{
+    iec61850->setJsonConfig (protocol_config_associations, exchanged_data,
+                             tls_config);
+
+    IedModel* model = ConfigFileParser_createModelFromConfigFileEx (
+        "../tests/data/simpleIO_direct_control.cfg");
+
+    IedServer server = IedServer_create (model);
+
+    IedServer_start (server, 10002);
+    iec61850->start ();
+
+    auto start = std::chrono::high_resolution_clock::now ();
+    auto timeout = std::chrono::seconds (10);
+    while (!iec61850->m_client->m_active_connection
+           || !iec61850->m_client->m_active_connection->Connected ())
+    {
+        auto now = std::chrono::high_resolution_clock::now ();
+        if (now - start > timeout)
+        {
+            IedServer_stop (server);
+            IedServer_destroy (server);
+            IedModel_destroy (model);
+            FAIL () << "Connection not established within timeout";
+        }
+        Thread_sleep (10);
+    }
+
+    auto connection = iec61850->m_client->m_active_connection;
+
+    ASSERT_EQ (connection->m_readAssociations.size (), 2);
+    ASSERT_EQ (connection->m_readWindow (),
+               2 * iec61850->m_config->getMaxOutstandingReads ());
+
+    // reads never go over the association that carries control
+    IedConnection readConnection = connection->m_readConnection ();
+    ASSERT_NE (readConnection, connection->m_connection);
+    ASSERT_EQ (IedConnection_getState (readConnection), IED_STATE_CONNECTED);
+
+    IedServer_stop (server);
+    IedServer_destroy (server);
+    IedModel_destroy (model);
+}
+
+TEST_F (ConnectionHandlingTest, LateVarSpecResponse)
+{
+    iec61850->setJsonConfig (protocol_config_associations, exchanged_data,
+                             tls_config);
+
+    IedModel* model = ConfigFileParser_createModelFromConfigFileEx (
+        "../tests/data/simpleIO_direct_control.cfg");
+
+    IedServer server = IedServer_create (model);
+
+    IedServer_start (server, 10002);
+    iec61850->start ();
+
+    auto start = std::chrono::high_resolution_clock::now ();
+    auto timeout = std::chrono::seconds (10);
+    while (!iec61850->m_client->m_active_connection
+           || !iec61850->m_client->m_active_connection->Connected ())
+    {
+        auto now = std::chrono::high_resolution_clock::now ();
+        if (now - start > timeout)
+        {
+            IedServer_stop (server);
+            IedServer_destroy (server);
+            IedModel_destroy (model);
+            FAIL () << "Connection not established within timeout";
+        }
+        Thread_sleep (10);
+    }
+
+    auto connection = iec61850->m_client->m_active_connection;
+
+    ASSERT_FALSE (connection->m_specRequestsOpen);
+    ASSERT_TRUE (connection->m_specRequests.empty ());
+
+    // a response to a request the bring-up stopped waiting for, addressing
+    // a slot that no longer exists
+    auto association = connection->m_acquireReadAssociation ();
+    ASSERT_NE (association, nullptr);
+    ASSERT_EQ (association->outstanding, 1);
+
+    auto call = new IEC61850ClientConnection::SpecCall{
+        connection, connection->m_specGeneration, 42, association
+    };
+    {
+        std::lock_guard<std::mutex> lock (connection->m_specLock);
+        connection->m_specCalls.insert (call);
+    }
+
+    IEC61850ClientConnection::varSpecHandler (0, call, IED_ERROR_TIMEOUT,
+                                              nullptr);
+
+    ASSERT_EQ (association->outstanding, 0);
+    ASSERT_TRUE (connection->m_specCalls.empty ());
+    ASSERT_TRUE (connection->m_specRequests.empty ());
+
+    IedServer_stop (server);
+    IedServer_destroy (server);
+    IedModel_destroy (model);
+}
+
+TEST_F (ConnectionHandlingTest, EventDrivenConnectionThread)
+{
+    iec61850->setJsonConfig (protocol_config, exchanged_data, tls_config);
+
+    IedModel* model = ConfigFileParser_createModelFromConfigFileEx (
+        "../tests/data/simpleIO_direct_control.cfg");
+
+    IedServer server = IedServer_create (model);
+
+    IedServer_start (server, 10002);
+    iec61850->start ();
+
+    auto start = std::chrono::high_resolution_clock::now ();
+    auto timeout = std::chrono::seconds (10);
+    while (!iec61850->m_client->m_active_connection
+           || !iec61850->m_client->m_active_connection->Connected ())
+    {
+        auto now = std::chrono::high_resolution_clock::now ();
+        if (now - start > timeout)
+        {
+            IedServer_stop (server);
+            IedServer_destroy (server);
+            IedModel_destroy (model);
+            FAIL () << "Connection not established within timeout";
+        }
+        Thread_sleep (10);
+    }
+
+    auto connection = iec61850->m_client->m_active_connection;
+
+    // nothing to poll and no pending command: sleep until an event arrives
+    ASSERT_EQ (connection->m_nextWakeUpTime (), UINT64_MAX);
+
+    // losing the association wakes the connection thread right away
+    IedServer_stop (server);
+
+    start = std::chrono::high_resolution_clock::now ();
+    timeout = std::chrono::seconds (1);
+    while (connection->m_connectionState
+           == IEC61850ClientConnection::CON_STATE_CONNECTED)
+    {
+        auto now = std::chrono::high_resolution_clock::now ();
+        if (now - start > timeout)
+        {
+            IedServer_destroy (server);
+            IedModel_destroy (model);
+            FAIL () << "Connection loss not handled within timeout";
+        }
+        Thread_sleep (1);
+    }
+
+    IedServer_destroy (server);
+    IedModel_destroy (model);
+}
@@ -35,6 +35,26 @@ static string protocol_config = QUOTE({
     }
 });
 
+static string protocol_config_single_command = QUOTE({
+    "protocol_stack" : {
+        "name" : "iec61850client",
+        "version" : "0.0.1",
+        "transport_layer" : {
+            "ied_name" : "IED1",
+            "connections" : [
+                {
+                    "ip_addr" : "127.0.0.1",
+                    "port" : 10002
+                }
+            ]
+        },
+        "application_layer" : {
+            "polling_interval" : 0,
+            "max_concurrent_commands" : 1
+        }
+    }
+});
+
 // PLUGIN DEFAULT EXCHANGED DATA CONF
 
 static string exchanged_data = QUOTE({
@@ -1121,4 +1141,332 @@ TEST_F(ControlTest, WriteOperations) {
     IedServer_stop(server);
     IedServer_destroy(server);
     IedModel_destroy(model);
-}
\ No newline at end of file
+}
+TEST_F(ControlTest, SingleCommandSboNormal) {
+    iec61850->setJsonConfig(protocol_config, exchanged_data, tls_config);
+
+    IedModel* model = ConfigFileParser_createModelFromConfigFileEx("../tests/data/simpleIO_control_tests.cfg");
+    IedServer server = IedServer_create(model);
+    IedServer_start(server,10002);
+
+    iec61850->start();
+
+    auto start = std::chrono::high_resolution_clock::now();
+    auto timeout = std::chrono::seconds(10);
+    while (!iec61850->m_client->m_active_connection || !iec61850->m_client->m_active_connection->Connected()) {
+        auto now = std::chrono::high_resolution_clock::now();
+        if (now - start > timeout) {
+            IedServer_stop(server);
+            IedServer_destroy(server);
+            IedModel_destroy(model);
+            FAIL() << "Connection not established within timeout";
+        }
+        Thread_sleep(10);
+    }
+
+    auto params = new PLUGIN_PARAMETER*[1];
+    params[0] = new PLUGIN_PARAMETER;
+    params[0]->name = std::string("Pivot");
+    params[0]->value = std::string(R"({"GTIC":{"ComingFrom":"iec61850", "SpcTyp":{"q":{"test":0}, "t":{"SecondSinceEpoch":1700566837, "FractionOfSecond":15921577}, "ctlVal":1}, "Identifier":"TS2", "Select":{"stVal":1}}})");
+    iec61850->operation("PivotCommand", 1, params);
+
+    delete params[0];
+    delete[] params;
+
+    // the operate follows the select confirmation without waiting for a tick
+    timeout = std::chrono::seconds(3);
+    start = std::chrono::high_resolution_clock::now();
+    while (ingestCallbackCalled != 1) {
+        auto now = std::chrono::high_resolution_clock::now();
+        if (now - start > timeout) {
+            IedServer_stop(server);
+            IedServer_destroy(server);
+            IedModel_destroy(model);
+            FAIL() << "Callback not called within timeout";
+        }
+        Thread_sleep(1);
+    }
+
+    ASSERT_NE(storedReading, nullptr);
+    Datapoint* commandResponse = storedReading->getReadingData()[0];
+    Datapoint* gtic = getChild(*commandResponse,"GTIC");
+    Datapoint* cause = getChild(*gtic,"Cause");
+
+    int expectedStVal = 7;
+    verifyDatapoint(cause, "stVal", &expectedStVal);
+
+    ASSERT_EQ(iec61850->m_client->m_active_connection->pendingControls(), 0);
+
+    IedServer_stop(server);
+    IedServer_destroy(server);
+    IedModel_destroy(model);
+}
+
+TEST_F(ControlTest, CommandContextsRecycled) {
+    iec61850->setJsonConfig(protocol_config, exchanged_data, tls_config);
+
+    IedModel* model = ConfigFileParser_createModelFromConfigFileEx("../tests/data/simpleIO_control_tests.cfg");
+    IedServer server = IedServer_create(model);
+    IedServer_start(server,10002);
+
+    iec61850->start();
+
+    auto start = std::chrono::high_resolution_clock::now();
+    auto timeout = std::chrono::seconds(10);
+    while (!iec61850->m_client->m_active_connection || !iec61850->m_client->m_active_connection->Connected()) {
+        auto now = std::chrono::high_resolution_clock::now();
+        if (now - start > timeout) {
+            IedServer_stop(server);
+            IedServer_destroy(server);
+            IedModel_destroy(model);
+            FAIL() << "Connection not established within timeout";
+        }
+        Thread_sleep(10);
+    }
+
+    auto connection = iec61850->m_client->m_active_connection;
+    size_t poolSize = connection->m_commandContexts.size();
+    ASSERT_EQ(poolSize, connection->m_controlObjects.size());
+
+    for (int i = 0; i < 5; i++) {
+        auto params = new PLUGIN_PARAMETER*[1];
+        params[0] = new PLUGIN_PARAMETER;
+        params[0]->name = std::string("Pivot");
+        params[0]->value = std::string(R"({"GTIC":{"ComingFrom":"iec61850", "SpcTyp":{"q":{"test":0}, "t":{"SecondSinceEpoch":1700566837, "FractionOfSecond":15921577}, "ctlVal":)") + std::to_string(i % 2) + R"(}, "Identifier":"TS1", "Select":{"stVal":0}}})";
+        iec61850->operation("PivotCommand", 1, params);
+
+        delete params[0];
+        delete[] params;
+
+        timeout = std::chrono::seconds(3);
+        start = std::chrono::high_resolution_clock::now();
+        while (ingestCallbackCalled != i + 1) {
+            auto now = std::chrono::high_resolution_clock::now();
+            if (now - start > timeout) {
+                IedServer_stop(server);
+                IedServer_destroy(server);
+                IedModel_destroy(model);
+                FAIL() << "Callback not called within timeout";
+            }
+            Thread_sleep(1);
+        }
+    }
+
+    // every command returned its context, none was allocated on the way
+    ASSERT_EQ(connection->pendingControls(), 0);
+    ASSERT_EQ(connection->m_commandContexts.size(), poolSize);
+    ASSERT_EQ(connection->m_freeCommandContexts.size(), poolSize);
+
+    IedServer_stop(server);
+    IedServer_destroy(server);
+    IedModel_destroy(model);
+}
+
+TEST_F(ControlTest, CommandQueuePerObject) {
+    iec61850->setJsonConfig(protocol_config_single_command, exchanged_data, tls_config);
+
+    IedModel* model = ConfigFileParser_createModelFromConfigFileEx("../tests/data/simpleIO_control_tests.cfg");
+    IedServer server = IedServer_create(model);
+    IedServer_start(server,10002);
+
+    iec61850->start();
+
+    auto start = std::chrono::high_resolution_clock::now();
+    auto timeout = std::chrono::seconds(10);
+    while (!iec61850->m_client->m_active_connection || !iec61850->m_client->m_active_connection->Connected()) {
+        auto now = std::chrono::high_resolution_clock::now();
+        if (now - start > timeout) {
+            IedServer_stop(server);
+            IedServer_destroy(server);
+            IedModel_destroy(model);
+            FAIL() << "Connection not established within timeout";
+        }
+        Thread_sleep(10);
+    }
+
+    // two commands to the same object and one to another, without waiting
+    const char* commands[] = { "TS1", "TS1", "TS2" };
+    const int values[] = { 1, 0, 1 };
+
+    for (int i = 0; i < 3; i++) {
+        auto params = new PLUGIN_PARAMETER*[1];
+        params[0] = new PLUGIN_PARAMETER;
+        params[0]->name = std::string("Pivot");
+        params[0]->value = std::string(R"({"GTIC":{"ComingFrom":"iec61850", "SpcTyp":{"q":{"test":0}, "t":{"SecondSinceEpoch":1700566837, "FractionOfSecond":15921577}, "ctlVal":)") + std::to_string(values[i]) + R"(}, "Identifier":")" + commands[i] + R"(", "Select":{"stVal":0}}})";
+        ASSERT_TRUE(iec61850->operation("PivotCommand", 1, params));
+
+        delete params[0];
+        delete[] params;
+    }
+
+    timeout = std::chrono::seconds(3);
+    start = std::chrono::high_resolution_clock::now();
+    while (ingestCallbackCalled != 3) {
+        auto now = std::chrono::high_resolution_clock::now();
+        if (now - start > timeout) {
+            IedServer_stop(server);
+            IedServer_destroy(server);
+            IedModel_destroy(model);
+            FAIL() << "Callback not called within timeout";
+        }
+        Thread_sleep(1);
+    }
+
+    // the commands to TS1 were acknowledged in the order they were sent
+    std::vector<int> ts1Values;
+    for (auto reading : storedReadings) {
+        if (reading->getAssetName() != "TS1")
+            continue;
+        Datapoint* gtic = getChild(*reading->getReadingData()[0], "GTIC");
+        Datapoint* spcTyp = getChild(*gtic, "SpcTyp");
+        ts1Values.push_back(getChild(*spcTyp, "ctlVal")->getData().toInt());
+    }
+
+    ASSERT_EQ(ts1Values.size(), 2);
+    ASSERT_EQ(ts1Values[0], 1);
+    ASSERT_EQ(ts1Values[1], 0);
+
+    ASSERT_EQ(iec61850->m_client->m_active_connection->pendingControls(), 0);
+    ASSERT_EQ(iec61850->m_client->m_commandTracker.size(), 0);
+
+    IedServer_stop(server);
+    IedServer_destroy(server);
+    IedModel_destroy(model);
+}
+
+TEST_F(ControlTest, CommandTimeoutFromDispatch) {
+    iec61850->setJsonConfig(protocol_config_single_command, exchanged_data, tls_config);
+
+    IedModel* model = ConfigFileParser_createModelFromConfigFileEx("../tests/data/simpleIO_control_tests.cfg");
+    IedServer server = IedServer_create(model);
+    IedServer_start(server,10002);
+
+    iec61850->start();
+
+    auto start = std::chrono::high_resolution_clock::now();
+    auto timeout = std::chrono::seconds(10);
+    while (!iec61850->m_client->m_active_connection || !iec61850->m_client->m_active_connection->Connected()) {
+        auto now = std::chrono::high_resolution_clock::now();
+        if (now - start > timeout) {
+            IedServer_stop(server);
+            IedServer_destroy(server);
+            IedModel_destroy(model);
+            FAIL() << "Connection not established within timeout";
+        }
+        Thread_sleep(10);
+    }
+
+    IEC61850Client* client = iec61850->m_client;
+    auto connection = client->m_active_connection;
+    auto co = connection->m_controlObjects.at("simpleIOGenericIO/GGIO1.SPCSO1");
+
+    // a queued command that was answered before its turn is not sent
+    DatapointValue label(std::string("TS1"));
+    uint64_t answered = client->m_commandTracker.add("TS1", new Datapoint("GTIC", label));
+    client->m_commandTracker.remove(answered);
+
+    {
+        std::vector<IEC61850ClientConnection::FailedControl> failed;
+        std::lock_guard<std::mutex> lock(connection->m_controlLock);
+        co->queue.push_back({DatapointValue(1L), answered});
+        connection->m_controlIdle(co);
+        connection->m_dispatchControls(failed);
+
+        ASSERT_TRUE(failed.empty());
+        ASSERT_TRUE(co->queue.empty());
+        ASSERT_TRUE(connection->m_pendingControls.empty());
+        ASSERT_EQ(co->state, IEC61850ClientConnection::CONTROL_IDLE);
+    }
+
+    // the timeout of a command only runs once it is sent
+    uint64_t commandId = client->m_commandTracker.add("TS1", new Datapoint("GTIC", label));
+    ASSERT_EQ(client->m_commandTracker.scheduled(), 0);
+
+    ASSERT_TRUE(connection->operate("simpleIOGenericIO/GGIO1.SPCSO1", DatapointValue(1L), commandId));
+
+    timeout = std::chrono::seconds(3);
+    start = std::chrono::high_resolution_clock::now();
+    while (client->m_commandTracker.size() != 0) {
+        auto now = std::chrono::high_resolution_clock::now();
+        if (now - start > timeout) {
+            IedServer_stop(server);
+            IedServer_destroy(server);
+            IedModel_destroy(model);
+            FAIL() << "Command not acknowledged within timeout";
+        }
+        Thread_sleep(1);
+    }
+
+    ASSERT_EQ(ingestCallbackCalled, 1);
+    ASSERT_EQ(client->m_commandTracker.scheduled(), 0);
+    ASSERT_EQ(connection->pendingControls(), 0);
+
+    IedServer_stop(server);
+    IedServer_destroy(server);
+    IedModel_destroy(model);
+}
+
+TEST_F(ControlTest, LateResponseAfterTimeout) {
+    iec61850->setJsonConfig(protocol_config_single_command, exchanged_data, tls_config);
+
+    IedModel* model = ConfigFileParser_createModelFromConfigFileEx("../tests/data/simpleIO_control_tests.cfg");
+    IedServer server = IedServer_create(model);
+    IedServer_start(server,10002);
+
+    iec61850->start();
+
+    auto start = std::chrono::high_resolution_clock::now();
+    auto timeout = std::chrono::seconds(10);
+    while (!iec61850->m_client->m_active_connection || !iec61850->m_client->m_active_connection->Connected()) {
+        auto now = std::chrono::high_resolution_clock::now();
+        if (now - start > timeout) {
+            IedServer_stop(server);
+            IedServer_destroy(server);
+            IedModel_destroy(model);
+            FAIL() << "Connection not established within timeout";
+        }
+        Thread_sleep(10);
+    }
+
+    auto connection = iec61850->m_client->m_active_connection;
+    auto co = connection->m_controlObjects.at("simpleIOGenericIO/GGIO1.SPCSO1");
+    size_t poolSize = connection->m_commandContexts.size();
+
+    // a command whose operate is still outstanding when it times out
+    IEC61850ClientConnection::CommandContext* context;
+    {
+        std::lock_guard<std::mutex> lock(connection->m_controlLock);
+        context = connection->m_acquireCommandContext(co);
+        context->commandId = 42;
+        context->deadline = 0;
+        context->responsePending = true;
+        co->state = IEC61850ClientConnection::CONTROL_WAIT_FOR_ACT_CON;
+    }
+
+    connection->m_expireCommandContexts(1);
+
+    // the context is not recycled while libiec61850 holds it
+    ASSERT_TRUE(context->expired);
+    ASSERT_EQ(connection->pendingControls(), 1);
+    ASSERT_EQ(connection->m_freeCommandContexts.size(), poolSize - 1);
+    ASSERT_EQ(co->state, IEC61850ClientConnection::CONTROL_WAIT_FOR_ACT_CON);
+
+    // the late confirmation recycles it without confirming the command
+    IEC61850ClientConnection::controlActionHandler(0, context, IED_ERROR_OK, CONTROL_ACTION_TYPE_OPERATE, true);
+
+    ASSERT_EQ(ingestCallbackCalled, 0);
+    ASSERT_EQ(connection->pendingControls(), 0);
+    ASSERT_EQ(connection->m_freeCommandContexts.size(), poolSize);
+    ASSERT_EQ(co->state, IEC61850ClientConnection::CONTROL_IDLE);
+
+    // a termination for a context that is no longer waiting for one is
+    // ignored
+    IEC61850ClientConnection::commandTerminationHandler(context, co->client);
+
+    ASSERT_EQ(ingestCallbackCalled, 0);
+    ASSERT_EQ(connection->m_freeCommandContexts.size(), poolSize);
+
+    IedServer_stop(server);
+    IedServer_destroy(server);
+    IedModel_destroy(model);
+}
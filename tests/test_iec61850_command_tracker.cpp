@@ -0,0 +1,130 @@
+#include <gtest/gtest.h>
+#include <iec61850_command_tracker.hpp>
+#include <memory>
+#include <string>
+#include <vector>
+
+class CommandTrackerTest : public testing::Test
+{
+  protected:
+    static Datapoint*
+    command (const std::string& label)
+    {
+        DatapointValue value (label);
+        return new Datapoint ("GTIC", value);
+    }
+
+    std::vector<std::string>
+    expire (IEC61850CommandTracker& tracker, uint64_t currentTime)
+    {
+        std::vector<std::unique_ptr<TrackedCommand> > expired;
+        tracker.expire (currentTime, expired);
+
+        std::vector<std::string> labels;
+        for (const auto& tracked : expired)
+            labels.push_back (tracked->label);
+        return labels;
+    }
+};
+
+TEST_F (CommandTrackerTest, ExpireAcrossLevels)
+{
+    IEC61850CommandTracker tracker (100, 1000);
+
+    // one deadline per wheel level and one beyond the range of the wheel
+    tracker.add ("TS1", command ("TS1"), 300, 1000);
+    tracker.add ("TS2", command ("TS2"), 30000, 1000);
+    tracker.add ("TS3", command ("TS3"), 1000000, 1000);
+    tracker.add ("TS4", command ("TS4"), 40000000, 1000);
+
+    ASSERT_EQ (tracker.size (), 4);
+
+    ASSERT_TRUE (expire (tracker, 1200).empty ());
+    ASSERT_EQ (expire (tracker, 1300), std::vector<std::string>{ "TS1" });
+
+    ASSERT_TRUE (expire (tracker, 30900).empty ());
+    ASSERT_EQ (expire (tracker, 31000), std::vector<std::string>{ "TS2" });
+
+    ASSERT_TRUE (expire (tracker, 1000900).empty ());
+    ASSERT_EQ (expire (tracker, 1001000), std::vector<std::string>{ "TS3" });
+
+    ASSERT_TRUE (expire (tracker, 40000900).empty ());
+    ASSERT_EQ (expire (tracker, 40001000), std::vector<std::string>{ "TS4" });
+
+    ASSERT_EQ (tracker.size (), 0);
+}
+
+TEST_F (CommandTrackerTest, AcknowledgeBeforeTimeout)
+{
+    IEC61850CommandTracker tracker (100, 0);
+
+    uint64_t first = tracker.add ("TS1", command ("TS1"), 1000, 0);
+    uint64_t second = tracker.add ("TS1", command ("TS1"), 1000, 500);
+
+    ASSERT_NE (first, second);
+
+    // ActCon of an enhanced command keeps it until its ActTerm
+    ASSERT_NE (tracker.acknowledge (first, false), nullptr);
+    ASSERT_EQ (tracker.size (), 2);
+
+    ASSERT_NE (tracker.acknowledge (first, true), nullptr);
+    ASSERT_EQ (tracker.size (), 1);
+
+    // only the command that was not acknowledged times out
+    std::vector<std::unique_ptr<TrackedCommand> > expired;
+    tracker.expire (1500, expired);
+    ASSERT_EQ (expired.size (), 1);
+    ASSERT_EQ (expired[0]->id, second);
+    ASSERT_FALSE (expired[0]->confirmed);
+
+    // a late acknowledgement of an expired command is not matched
+    ASSERT_EQ (tracker.acknowledge (second, true), nullptr);
+    ASSERT_EQ (tracker.size (), 0);
+}
+
+TEST_F (CommandTrackerTest, ManyCommandsInFlight)
+{
+    IEC61850CommandTracker tracker (100, 0);
+
+    for (int i = 0; i < 5000; i++)
+    {
+        uint64_t id = tracker.add ("TS" + std::to_string (i),
+                                   command ("TS"), 1000 + i, i);
+        if (i % 2 == 0)
+            tracker.remove (id);
+    }
+
+    ASSERT_EQ (tracker.size (), 2500);
+
+    std::vector<std::unique_ptr<TrackedCommand> > expired;
+    tracker.expire (11000, expired);
+
+    ASSERT_EQ (expired.size (), 2500);
+    ASSERT_EQ (tracker.size (), 0);
+}
+
+TEST_F (CommandTrackerTest, TimeoutStartsWhenScheduled)
+{
+    IEC61850CommandTracker tracker (100, 0);
+
+    // a queued command has no deadline yet
+    uint64_t id = tracker.add ("TS1", command ("TS1"));
+
+    ASSERT_EQ (tracker.size (), 1);
+    ASSERT_EQ (tracker.scheduled (), 0);
+    ASSERT_TRUE (expire (tracker, 100000).empty ());
+
+    ASSERT_TRUE (tracker.schedule (id, 1000, 100000));
+    ASSERT_EQ (tracker.scheduled (), 1);
+
+    ASSERT_TRUE (expire (tracker, 100900).empty ());
+    ASSERT_EQ (expire (tracker, 101000), std::vector<std::string>{ "TS1" });
+
+    // an answered command is not scheduled any more
+    uint64_t answered = tracker.add ("TS2", command ("TS2"));
+    tracker.remove (answered);
+
+    ASSERT_FALSE (tracker.schedule (answered, 1000, 101000));
+    ASSERT_EQ (tracker.size (), 0);
+    ASSERT_EQ (tracker.scheduled (), 0);
+}
@@ -469,6 +469,188 @@ static string wrong_protocol_config_17 = QUOTE({
     }
 });
 
+static string polling_mode_protocol_config = QUOTE({
+    "protocol_stack" : {
+        "name" : "iec61850client",
+        "version" : "0.0.1",
+        "transport_layer" : {
+            "ied_name" : "IED1",
+            "connections" : [
+                {
+                    "ip_addr" : "127.0.0.1",
+                    "port" : 10002
+                }
+            ]
+        },
+        "application_layer" : {
+            "polling_interval" : 1000,
+            "polling_mode" : "batched"
+        }
+    }
+});
+
+static string wrong_polling_mode_protocol_config = QUOTE({
+    "protocol_stack" : {
+        "name" : "iec61850client",
+        "version" : "0.0.1",
+        "transport_layer" : {
+            "ied_name" : "IED1",
+            "connections" : [
+                {
+                    "ip_addr" : "127.0.0.1",
+                    "port" : 10002
+                }
+            ]
+        },
+        "application_layer" : {
+            "polling_interval" : 1000,
+            "polling_mode" : "parallel"
+        }
+    }
+});
+
+static string pipelined_protocol_config = QUOTE({
+    "protocol_stack" : {
+        "name" : "iec61850client",
+        "version" : "0.0.1",
+        "transport_layer" : {
+            "ied_name" : "IED1",
+            "connections" : [
+                {
+                    "ip_addr" : "127.0.0.1",
+                    "port" : 10002
+                }
+            ]
+        },
+        "application_layer" : {
+            "polling_interval" : 1000,
+            "polling_mode" : "pipelined",
+            "max_outstanding_reads" : 4
+        }
+    }
+});
+
+static string polling_groups_protocol_config = QUOTE({
+    "protocol_stack" : {
+        "name" : "iec61850client",
+        "version" : "0.0.1",
+        "transport_layer" : {
+            "ied_name" : "IED1",
+            "connections" : [
+                {
+                    "ip_addr" : "127.0.0.1",
+                    "port" : 10002
+                }
+            ]
+        },
+        "application_layer" : {
+            "polling_interval" : 10000,
+            "polling_groups" : [
+                {
+                    "name" : "fast",
+                    "interval" : 500,
+                    "datapoints" : [ "TM1", "TM2" ]
+                },
+                {
+                    "name" : "slow",
+                    "interval" : 60000,
+                    "datapoints" : [ "TS1", "TM2" ]
+                }
+            ]
+        }
+    }
+});
+
+static string wrong_polling_groups_protocol_config = QUOTE({
+    "protocol_stack" : {
+        "name" : "iec61850client",
+        "version" : "0.0.1",
+        "transport_layer" : {
+            "ied_name" : "IED1",
+            "connections" : [
+                {
+                    "ip_addr" : "127.0.0.1",
+                    "port" : 10002
+                }
+            ]
+        },
+        "application_layer" : {
+            "polling_groups" : [
+                {
+                    "name" : "fast",
+                    "interval" : 0,
+                    "datapoints" : [ "TM1" ]
+                },
+                {
+                    "interval" : 500,
+                    "datapoints" : [ "TM2" ]
+                }
+            ]
+        }
+    }
+});
+
+static string change_only_protocol_config = QUOTE({
+    "protocol_stack" : {
+        "name" : "iec61850client",
+        "version" : "0.0.1",
+        "transport_layer" : {
+            "ied_name" : "IED1",
+            "connections" : [
+                {
+                    "ip_addr" : "127.0.0.1",
+                    "port" : 10002
+                }
+            ]
+        },
+        "application_layer" : {
+            "polling_interval" : 1000,
+            "change_only" : true,
+            "forced_refresh" : 60000
+        }
+    }
+});
+
+static string report_queue_size_protocol_config = QUOTE({
+    "protocol_stack" : {
+        "name" : "iec61850client",
+        "version" : "0.0.1",
+        "transport_layer" : {
+            "ied_name" : "IED1",
+            "connections" : [
+                {
+                    "ip_addr" : "127.0.0.1",
+                    "port" : 10002
+                }
+            ]
+        },
+        "application_layer" : {
+            "polling_interval" : 1000,
+            "report_queue_size" : 100
+        }
+    }
+});
+
+static string conversion_workers_protocol_config = QUOTE({
+    "protocol_stack" : {
+        "name" : "iec61850client",
+        "version" : "0.0.1",
+        "transport_layer" : {
+            "ied_name" : "IED1",
+            "connections" : [
+                {
+                    "ip_addr" : "127.0.0.1",
+                    "port" : 10002
+                }
+            ]
+        },
+        "application_layer" : {
+            "polling_interval" : 1000,
+            "conversion_workers" : 4
+        }
+    }
+});
+
 static string exchanged_data = QUOTE({
  "exchanged_data": {
   "datapoints": [
@@ -1105,4 +1287,426 @@ TEST_F(ConfigTest, ProtocolConfigBuftmIntgpd) {
     config->importProtocolConfig(wrong_protocol_config_17);
 
     ASSERT_TRUE(config->m_protocolConfigComplete);
-}
\ No newline at end of file
+}
+
+TEST_F(ConfigTest, ProtocolConfigPollingMode) {
+
+    IEC61850ClientConfig* config = new IEC61850ClientConfig();
+
+    ASSERT_EQ(config->getPollingMode(), POLLING_SEQUENTIAL);
+
+    config->importProtocolConfig(polling_mode_protocol_config);
+
+    ASSERT_TRUE(config->m_protocolConfigComplete);
+    ASSERT_EQ(config->getPollingMode(), POLLING_BATCHED);
+}
+
+TEST_F(ConfigTest, ProtocolConfigWrongPollingMode) {
+
+    IEC61850ClientConfig* config = new IEC61850ClientConfig();
+
+    config->importProtocolConfig(wrong_polling_mode_protocol_config);
+
+    ASSERT_FALSE(config->m_protocolConfigComplete);
+    ASSERT_EQ(config->getPollingMode(), POLLING_SEQUENTIAL);
+}
+
+TEST_F(ConfigTest, ProtocolConfigMaxOutstandingReads) {
+
+    IEC61850ClientConfig* config = new IEC61850ClientConfig();
+
+    ASSERT_EQ(config->getMaxOutstandingReads(), 8);
+
+    config->importProtocolConfig(pipelined_protocol_config);
+
+    ASSERT_TRUE(config->m_protocolConfigComplete);
+    ASSERT_EQ(config->getPollingMode(), POLLING_PIPELINED);
+    ASSERT_EQ(config->getMaxOutstandingReads(), 4);
+}
+
+TEST_F(ConfigTest, ProtocolConfigPollingGroups) {
+
+    IEC61850ClientConfig* config = new IEC61850ClientConfig();
+
+    config->importExchangeConfig(exchanged_data);
+    config->importProtocolConfig(polling_groups_protocol_config);
+
+    ASSERT_TRUE(config->m_protocolConfigComplete);
+    ASSERT_EQ(config->getPollingGroups().size(), 3);
+
+    auto fast = config->getPollingGroups()[0];
+    ASSERT_EQ(fast->name, "fast");
+    ASSERT_EQ(fast->interval, 500);
+    ASSERT_EQ(fast->polledDatapoints.size(), 2);
+
+    auto slow = config->getPollingGroups()[1];
+    ASSERT_EQ(slow->name, "slow");
+    ASSERT_EQ(slow->polledDatapoints.size(), 1);
+
+    auto defaultGroup = config->getPollingGroups()[2];
+    ASSERT_EQ(defaultGroup->name, "default");
+    ASSERT_EQ(defaultGroup->interval, 10000);
+    ASSERT_EQ(defaultGroup->polledDatapoints.size(),
+              config->polledDatapoints().size() - 3);
+}
+
+TEST_F(ConfigTest, ProtocolConfigWrongPollingGroups) {
+
+    IEC61850ClientConfig* config = new IEC61850ClientConfig();
+
+    config->importExchangeConfig(exchanged_data);
+    config->importProtocolConfig(wrong_polling_groups_protocol_config);
+
+    ASSERT_TRUE(config->m_protocolConfigComplete);
+    ASSERT_TRUE(config->getPollingGroups().empty());
+}
+
+TEST_F(ConfigTest, ProtocolConfigChangeOnly) {
+
+    IEC61850ClientConfig* config = new IEC61850ClientConfig();
+
+    ASSERT_FALSE(config->getChangeOnly());
+    ASSERT_EQ(config->getForcedRefresh(), 0);
+
+    config->importProtocolConfig(change_only_protocol_config);
+
+    ASSERT_TRUE(config->m_protocolConfigComplete);
+    ASSERT_TRUE(config->getChangeOnly());
+    ASSERT_EQ(config->getForcedRefresh(), 60000);
+}
+
+TEST_F(ConfigTest, ProtocolConfigReportQueueSize) {
+
+    IEC61850ClientConfig* config = new IEC61850ClientConfig();
+
+    ASSERT_EQ(config->getReportQueueSize(), 1024);
+
+    config->importProtocolConfig(report_queue_size_protocol_config);
+
+    ASSERT_TRUE(config->m_protocolConfigComplete);
+    ASSERT_EQ(config->getReportQueueSize(), 100);
+}
+
+TEST_F(ConfigTest, ProtocolConfigConversionWorkers) {
+
+    IEC61850ClientConfig* config = new IEC61850ClientConfig();
+
+    ASSERT_EQ(config->getConversionWorkers(), 0);
+
+    config->importProtocolConfig(conversion_workers_protocol_config);
+
+    ASSERT_TRUE(config->m_protocolConfigComplete);
+    ASSERT_EQ(config->getConversionWorkers(), 4);
+}
+
+TEST_F(ConfigTest, ExchangeConfigDefinitionHandles) {
+
+    IEC61850ClientConfig* config = new IEC61850ClientConfig();
+
+    std::string exchangeConfig = R"({"exchanged_data":{"datapoints":[)";
+
+    for (int i = 0; i < 1000; i++) {
+        std::string n = std::to_string(i);
+        if (i > 0)
+            exchangeConfig += ",";
+        exchangeConfig += R"({"label":"TS)" + n + R"(","pivot_id":"ID)" + n
+            + R"(","protocols":[{"name":"iec61850","objref":"LD/GGIO1.Ind)"
+            + n + R"(","cdc":"SpsTyp"}]})";
+    }
+    exchangeConfig += "]}}";
+
+    config->importExchangeConfig(exchangeConfig);
+
+    auto& definitions = config->ExchangeDefinition();
+    ASSERT_EQ(definitions.size(), 1000);
+
+    for (size_t i = 0; i < definitions.size(); i++) {
+        DataExchangeDefinition* def = &definitions[i];
+        std::string n = std::to_string(i);
+
+        ASSERT_EQ(def->handle, i);
+        ASSERT_EQ(config->getExchangeDefinition(def->handle), def);
+        ASSERT_EQ(config->getExchangeDefinitionByLabel("TS" + n), def);
+        ASSERT_EQ(config->getExchangeDefinitionByPivotId("ID" + n), def);
+        ASSERT_EQ(config->getExchangeDefinitionByObjRef("LD/GGIO1.Ind" + n),
+                  def);
+    }
+
+    ASSERT_EQ(config->getExchangeDefinition(1000), nullptr);
+    ASSERT_EQ(config->getExchangeDefinitionByLabel("TS1000"), nullptr);
+    ASSERT_EQ(config->getExchangeDefinitionByObjRef("LD/GGIO1.Ind1000"),
+              nullptr);
+
+    delete config;
+}
+
+TEST_F(ConfigTest, ExchangeConfigSharedObjRef) {
+
+    IEC61850ClientConfig* config = new IEC61850ClientConfig();
+
+    config->importExchangeConfig(QUOTE({
+        "exchanged_data" : {
+            "datapoints" : [
+                {
+                    "label" : "TM1", "pivot_id" : "TM1",
+                    "protocols" : [ { "name" : "iec61850",
+                        "objref" : "LD/GGIO1.AnIn1", "cdc" : "MvTyp" } ]
+                },
+                {
+                    "label" : "TM2", "pivot_id" : "TM2",
+                    "protocols" : [ { "name" : "iec61850",
+                        "objref" : "LD/GGIO1.AnIn1", "cdc" : "MvTyp" } ]
+                },
+                {
+                    "label" : "TS1", "pivot_id" : "TS1",
+                    "protocols" : [ { "name" : "iec61850",
+                        "objref" : "LD/GGIO1.AnIn1", "cdc" : "SpsTyp" } ]
+                },
+                {
+                    "label" : "TM3", "pivot_id" : "TM3",
+                    "protocols" : [ { "name" : "iec61850",
+                        "objref" : "LD/GGIO1.AnIn1", "cdc" : "MvTyp" } ]
+                }
+            ]
+        }
+    }));
+
+    auto tm1 = config->getExchangeDefinitionByLabel("TM1");
+    auto tm2 = config->getExchangeDefinitionByLabel("TM2");
+    auto tm3 = config->getExchangeDefinitionByLabel("TM3");
+
+    ASSERT_NE(tm1, nullptr);
+    ASSERT_NE(tm2, nullptr);
+    ASSERT_NE(tm3, nullptr);
+
+    // another functional constraint on the same object is not read with it
+    ASSERT_EQ(config->getExchangeDefinitionByLabel("TS1"), nullptr);
+
+    ASSERT_EQ(config->getExchangeDefinitionByObjRef("LD/GGIO1.AnIn1"), tm1);
+    ASSERT_EQ(tm1->nextSameObjRef, tm2);
+    ASSERT_EQ(tm2->nextSameObjRef, tm3);
+    ASSERT_EQ(tm3->nextSameObjRef, nullptr);
+
+    ASSERT_EQ(config->polledDatapoints().size(), 1);
+
+    delete config;
+}
+
+TEST_F(ConfigTest, ProtocolConfigModelCache) {
+
+    IEC61850ClientConfig* config = new IEC61850ClientConfig();
+
+    ASSERT_TRUE(config->getModelCacheDir().empty());
+
+    config->importProtocolConfig(QUOTE({
+        "protocol_stack" : {
+            "name" : "iec61850client",
+            "version" : "0.0.1",
+            "transport_layer" : {
+                "ied_name" : "IED1",
+                "connections" : [ { "ip_addr" : "127.0.0.1", "port" : 10002 } ]
+            },
+            "application_layer" : {
+                "polling_interval" : 1000,
+                "model_cache" : "/tmp"
+            }
+        }
+    }));
+
+    ASSERT_TRUE(config->m_protocolConfigComplete);
+    ASSERT_EQ(config->getModelCacheDir(), "/tmp");
+
+    delete config;
+}
+
+TEST_F(ConfigTest, ProtocolConfigAutoReporting) {
+
+    IEC61850ClientConfig* config = new IEC61850ClientConfig();
+
+    ASSERT_FALSE(config->getAutoReporting());
+    ASSERT_EQ(config->getMaxDatasetEntries(), 100);
+
+    config->importProtocolConfig(QUOTE({
+        "protocol_stack" : {
+            "name" : "iec61850client",
+            "version" : "0.0.1",
+            "transport_layer" : {
+                "ied_name" : "IED1",
+                "connections" : [ { "ip_addr" : "127.0.0.1", "port" : 10002 } ]
+            },
+            "application_layer" : {
+                "polling_interval" : 1000,
+                "auto_reporting" : true,
+                "max_dataset_entries" : 16
+            }
+        }
+    }));
+
+    ASSERT_TRUE(config->m_protocolConfigComplete);
+    ASSERT_TRUE(config->getAutoReporting());
+    ASSERT_EQ(config->getMaxDatasetEntries(), 16);
+
+    delete config;
+}
+
+TEST_F(ConfigTest, ProtocolConfigAssociations) {
+
+    IEC61850ClientConfig* config = new IEC61850ClientConfig();
+
+    ASSERT_EQ(config->getAssociations(), 1);
+
+    config->importProtocolConfig(QUOTE({
+        "protocol_stack" : {
+            "name" : "iec61850client",
+            "version" : "0.0.1",
+            "transport_layer" : {
+                "ied_name" : "IED1",
+                "connections" : [ { "ip_addr" : "127.0.0.1", "port" : 10002 } ]
+            },
+            "application_layer" : {
+                "polling_interval" : 1000,
+                "associations" : 0
+            }
+        }
+    }));
+
+    ASSERT_FALSE(config->m_protocolConfigComplete);
+    ASSERT_EQ(config->getAssociations(), 1);
+
+    config->importProtocolConfig(QUOTE({
+        "protocol_stack" : {
+            "name" : "iec61850client",
+            "version" : "0.0.1",
+            "transport_layer" : {
+                "ied_name" : "IED1",
+                "connections" : [ { "ip_addr" : "127.0.0.1", "port" : 10002 } ]
+            },
+            "application_layer" : {
+                "polling_interval" : 1000,
+                "associations" : 4
+            }
+        }
+    }));
+
+    ASSERT_TRUE(config->m_protocolConfigComplete);
+    ASSERT_EQ(config->getAssociations(), 4);
+
+    delete config;
+}
+
+TEST_F(ConfigTest, ProtocolConfigMinimalReads) {
+
+    IEC61850ClientConfig* config = new IEC61850ClientConfig();
+
+    ASSERT_FALSE(config->getMinimalReads());
+
+    config->importProtocolConfig(QUOTE({
+        "protocol_stack" : {
+            "name" : "iec61850client",
+            "version" : "0.0.1",
+            "transport_layer" : {
+                "ied_name" : "IED1",
+                "connections" : [ { "ip_addr" : "127.0.0.1", "port" : 10002 } ]
+            },
+            "application_layer" : {
+                "polling_interval" : 1000,
+                "minimal_reads" : true
+            }
+        }
+    }));
+
+    ASSERT_TRUE(config->m_protocolConfigComplete);
+    ASSERT_TRUE(config->getMinimalReads());
+
+    delete config;
+}
+
+TEST_F(ConfigTest, ProtocolConfigMaxConcurrentCommands) {
+
+    IEC61850ClientConfig* config = new IEC61850ClientConfig();
+
+    ASSERT_EQ(config->getMaxConcurrentCommands(), 16);
+
+    config->importProtocolConfig(QUOTE({
+        "protocol_stack" : {
+            "name" : "iec61850client",
+            "version" : "0.0.1",
+            "transport_layer" : {
+                "ied_name" : "IED1",
+                "connections" : [ { "ip_addr" : "127.0.0.1", "port" : 10002 } ]
+            },
+            "application_layer" : {
+                "polling_interval" : 1000,
+                "max_concurrent_commands" : 0
+            }
+        }
+    }));
+
+    ASSERT_FALSE(config->m_protocolConfigComplete);
+    ASSERT_EQ(config->getMaxConcurrentCommands(), 16);
+
+    config->importProtocolConfig(QUOTE({
+        "protocol_stack" : {
+            "name" : "iec61850client",
+            "version" : "0.0.1",
+            "transport_layer" : {
+                "ied_name" : "IED1",
+                "connections" : [ { "ip_addr" : "127.0.0.1", "port" : 10002 } ]
+            },
+            "application_layer" : {
+                "polling_interval" : 1000,
+                "max_concurrent_commands" : 200
+            }
+        }
+    }));
+
+    ASSERT_TRUE(config->m_protocolConfigComplete);
+    ASSERT_EQ(config->getMaxConcurrentCommands(), 200);
+
+    delete config;
+}
+
+TEST_F(ConfigTest, ProtocolConfigCommandTimeout) {
+
+    IEC61850ClientConfig* config = new IEC61850ClientConfig();
+
+    ASSERT_EQ(config->getCommandTimeout(), 30000);
+
+    config->importProtocolConfig(QUOTE({
+        "protocol_stack" : {
+            "name" : "iec61850client",
+            "version" : "0.0.1",
+            "transport_layer" : {
+                "ied_name" : "IED1",
+                "connections" : [ { "ip_addr" : "127.0.0.1", "port" : 10002 } ]
+            },
+            "application_layer" : {
+                "polling_interval" : 1000,
+                "command_timeout" : -5
+            }
+        }
+    }));
+
+    ASSERT_FALSE(config->m_protocolConfigComplete);
+    ASSERT_EQ(config->getCommandTimeout(), 30000);
+
+    config->importProtocolConfig(QUOTE({
+        "protocol_stack" : {
+            "name" : "iec61850client",
+            "version" : "0.0.1",
+            "transport_layer" : {
+                "ied_name" : "IED1",
+                "connections" : [ { "ip_addr" : "127.0.0.1", "port" : 10002 } ]
+            },
+            "application_layer" : {
+                "polling_interval" : 1000,
+                "command_timeout" : 5000
+            }
+        }
+    }));
+
+    ASSERT_TRUE(config->m_protocolConfigComplete);
+    ASSERT_EQ(config->getCommandTimeout(), 5000);
+
+    delete config;
+}
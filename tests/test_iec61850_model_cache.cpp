@@ -0,0 +1,136 @@
+#include <cstdio>
+#include <fstream>
+#include <gtest/gtest.h>
+#include <iec61850_model_cache.hpp>
+#include <libiec61850/mms_type_spec.h>
+#include <string>
+#include <vector>
+
+#define QUOTE(...) #__VA_ARGS__
+
+static const char* CACHE_PATH = "./iec61850_model_127.0.0.1_10002.json";
+
+static std::string model_cache = QUOTE ({
+    "identity" : "TEMPLATELD1=1;",
+    "specs" : {
+        "TEMPLATELD1/GGIO1.AnIn1[1]" : {
+            "n" : "AnIn1",
+            "t" : 1,
+            "s" : 3,
+            "c" : [
+                { "n" : "mag", "t" : 1, "s" : 1,
+                  "c" : [ { "n" : "f", "t" : 6, "s" : 32, "w" : 8 } ] },
+                { "n" : "q", "t" : 3, "s" : 13 },
+                { "n" : "t", "t" : 14, "s" : 8 }
+            ]
+        }
+    },
+    "controls" : { "TEMPLATELD1/GGIO1.SPCSO1" : 1 },
+    "datasets" : {
+        "TEMPLATELD1/LLN0.Mags" : [ "TEMPLATELD1/GGIO1.AnIn1[MX]" ]
+    }
+});
+
+class ModelCacheTest : public testing::Test
+{
+  protected:
+    void
+    SetUp () override
+    {
+        std::ofstream file (CACHE_PATH, std::ios::trunc);
+        file << model_cache;
+    }
+
+    void
+    TearDown () override
+    {
+        std::remove (CACHE_PATH);
+    }
+};
+
+TEST_F (ModelCacheTest, LoadMatchingIdentity)
+{
+    IEC61850ModelCache cache (".", "127.0.0.1", 10002);
+
+    ASSERT_TRUE (cache.validate ("TEMPLATELD1=1;"));
+    ASSERT_FALSE (cache.dirty ());
+
+    MmsVariableSpecification* spec
+        = cache.getSpec ("TEMPLATELD1/GGIO1.AnIn1", IEC61850_FC_MX);
+    ASSERT_NE (spec, nullptr);
+    ASSERT_EQ (MmsVariableSpecification_getType (spec), MMS_STRUCTURE);
+    ASSERT_EQ (MmsVariableSpecification_getSize (spec), 3);
+
+    int index = -1;
+    MmsVariableSpecification* mag
+        = MmsVariableSpecification_getChildSpecificationByName (spec, "mag",
+                                                                &index);
+    ASSERT_NE (mag, nullptr);
+    ASSERT_EQ (index, 0);
+    MmsVariableSpecification* f
+        = MmsVariableSpecification_getChildSpecificationByName (mag, "f",
+                                                                nullptr);
+    ASSERT_NE (f, nullptr);
+    ASSERT_EQ (MmsVariableSpecification_getType (f), MMS_FLOAT);
+    ASSERT_EQ (MmsVariableSpecification_getExponentWidth (f), 8);
+    MmsVariableSpecification_destroy (spec);
+
+    ASSERT_EQ (cache.getSpec ("TEMPLATELD1/GGIO1.AnIn1", IEC61850_FC_ST),
+               nullptr);
+
+    ControlModel mode;
+    ASSERT_TRUE (cache.getControlModel ("TEMPLATELD1/GGIO1.SPCSO1", mode));
+    ASSERT_EQ (mode, CONTROL_MODEL_DIRECT_NORMAL);
+
+    std::vector<std::string> entries;
+    ASSERT_TRUE (cache.getDataSetDirectory ("TEMPLATELD1/LLN0.Mags", entries));
+    ASSERT_EQ (entries.size (), 1);
+    ASSERT_EQ (entries[0], "TEMPLATELD1/GGIO1.AnIn1[MX]");
+}
+
+TEST_F (ModelCacheTest, DropOnIdentityChange)
+{
+    IEC61850ModelCache cache (".", "127.0.0.1", 10002);
+
+    ASSERT_TRUE (cache.validate ("TEMPLATELD1=2;"));
+    ASSERT_TRUE (cache.dirty ());
+
+    ControlModel mode;
+    ASSERT_EQ (cache.getSpec ("TEMPLATELD1/GGIO1.AnIn1", IEC61850_FC_MX),
+               nullptr);
+    ASSERT_FALSE (cache.getControlModel ("TEMPLATELD1/GGIO1.SPCSO1", mode));
+
+    ASSERT_FALSE (cache.validate (""));
+}
+
+TEST_F (ModelCacheTest, SaveAndReload)
+{
+    {
+        IEC61850ModelCache cache (".", "127.0.0.1", 10002);
+        ASSERT_TRUE (cache.validate ("TEMPLATELD1=1;"));
+
+        MmsVariableSpecification* spec
+            = cache.getSpec ("TEMPLATELD1/GGIO1.AnIn1", IEC61850_FC_MX);
+        cache.putSpec ("TEMPLATELD1/GGIO1.AnIn2", IEC61850_FC_MX, spec);
+        MmsVariableSpecification_destroy (spec);
+
+        cache.putControlModel ("TEMPLATELD1/GGIO1.SPCSO2",
+                               CONTROL_MODEL_SBO_ENHANCED);
+        ASSERT_TRUE (cache.dirty ());
+        ASSERT_TRUE (cache.save ());
+        ASSERT_FALSE (cache.dirty ());
+    }
+
+    IEC61850ModelCache cache (".", "127.0.0.1", 10002);
+    ASSERT_TRUE (cache.validate ("TEMPLATELD1=1;"));
+
+    MmsVariableSpecification* spec
+        = cache.getSpec ("TEMPLATELD1/GGIO1.AnIn2", IEC61850_FC_MX);
+    ASSERT_NE (spec, nullptr);
+    ASSERT_EQ (MmsVariableSpecification_getSize (spec), 3);
+    MmsVariableSpecification_destroy (spec);
+
+    ControlModel mode;
+    ASSERT_TRUE (cache.getControlModel ("TEMPLATELD1/GGIO1.SPCSO2", mode));
+    ASSERT_EQ (mode, CONTROL_MODEL_SBO_ENHANCED);
+}
@@ -0,0 +1,212 @@
+#include <gtest/gtest.h>
+#include <iec61850.hpp>
+#include <plugin_api.h>
+
+#include <string>
+#include <vector>
+
+using namespace std;
+
+static string exchanged_data = QUOTE({
+ "exchanged_data": {
+  "datapoints": [
+   {
+    "pivot_id": "TS1",
+    "label": "TS1",
+    "protocols": [
+     {
+      "name": "iec61850",
+      "objref": "TEMPLATELD1/GGIO1.Ind1",
+      "cdc": "SpsTyp"
+     }
+    ]
+   },
+   {
+    "pivot_id": "TS2",
+    "label": "TS2",
+    "protocols": [
+     {
+      "name": "iec61850",
+      "objref": "TEMPLATELD1/GGIO1.Ind2",
+      "cdc": "DpsTyp"
+     }
+    ]
+   },
+   {
+    "pivot_id": "TM1",
+    "label": "TM1",
+    "protocols": [
+     {
+      "name": "iec61850",
+      "objref": "TEMPLATELD1/GGIO1.AnIn1",
+      "cdc": "MvTyp"
+     }
+    ]
+   },
+   {
+    "pivot_id": "TS3",
+    "label": "TS3",
+    "protocols": [
+     {
+      "name": "iec61850",
+      "objref": "TEMPLATELD1/GGIO1.SPCSO1",
+      "cdc": "SpcTyp"
+     }
+    ]
+   }
+  ]
+ }
+});
+
+// the expected reading, built node by node
+static Datapoint* dictDp(const string& name) {
+    auto* datapoints = new vector<Datapoint*>;
+    DatapointValue dpv(datapoints, true);
+    return new Datapoint(name, dpv);
+}
+
+template <class T>
+static Datapoint* valueDp(const string& name, const T value) {
+    DatapointValue dpv(value);
+    return new Datapoint(name, dpv);
+}
+
+static Datapoint* addDp(Datapoint* parent, Datapoint* child) {
+    parent->getData().getDpVec()->push_back(child);
+    return child;
+}
+
+static Datapoint* buildReading(const string& root, const string& label,
+                               const string& cdc, Datapoint* value) {
+    Datapoint* pivot = dictDp("PIVOT");
+    Datapoint* rootDp = addDp(pivot, dictDp(root));
+    addDp(rootDp, valueDp("ComingFrom", string("iec61850")));
+    addDp(rootDp, valueDp("Identifier", label));
+    Datapoint* cdcDp = addDp(rootDp, dictDp(cdc));
+    addDp(cdcDp, value);
+    Datapoint* q = addDp(cdcDp, dictDp("q"));
+    addDp(q, valueDp("test", 0L));
+    addDp(q, valueDp("Validity", string("good")));
+    addDp(q, dictDp("DetailQuality"));
+    Datapoint* t = addDp(cdcDp, dictDp("t"));
+    addDp(t, valueDp("SecondSinceEpoch", 1L));
+    addDp(t, valueDp("FractionOfSecond", 0L));
+    return pivot;
+}
+
+static Datapoint* childAt(Datapoint* dp, size_t index) {
+    return (*dp->getData().getDpVec())[index];
+}
+
+static bool sameTree(Datapoint* a, Datapoint* b) {
+    if (a->getName() != b->getName() ||
+        a->getData().getType() != b->getData().getType())
+        return false;
+
+    if (a->getData().getType() != DatapointValue::T_DP_DICT)
+        return a->getData().toString() == b->getData().toString();
+
+    auto childrenA = a->getData().getDpVec();
+    auto childrenB = b->getData().getDpVec();
+
+    if (childrenA->size() != childrenB->size()) return false;
+
+    for (size_t i = 0; i < childrenA->size(); i++) {
+        if (!sameTree((*childrenA)[i], (*childrenB)[i])) return false;
+    }
+
+    return true;
+}
+
+class PivotTemplateTest : public testing::Test {
+   protected:
+    void SetUp() {
+        config = new IEC61850ClientConfig();
+        config->importExchangeConfig(exchanged_data);
+    }
+
+    void TearDown() {
+        delete client;
+        delete config;
+    }
+
+    IEC61850ClientConfig* config = nullptr;
+    IEC61850Client* client = nullptr;
+};
+
+TEST_F(PivotTemplateTest, BuiltByClient) {
+    auto def = config->getExchangeDefinitionByLabel("TS3");
+
+    ASSERT_NE(def, nullptr);
+    ASSERT_EQ(def->pivotTemplate, nullptr);
+    ASSERT_EQ(def->converter, nullptr);
+
+    client = new IEC61850Client(nullptr, config);
+
+    ASSERT_NE(def->pivotTemplate, nullptr);
+    ASSERT_EQ(def->converter, IEC61850Client::cdcConverter(SPC));
+
+    const PivotTemplate& pivotTemplate = *def->pivotTemplate;
+
+    Datapoint* pivot = pivotTemplate.pivot.get();
+    ASSERT_EQ(pivot->getName(), "PIVOT");
+
+    Datapoint* root = childAt(pivot, pivotTemplate.root);
+    ASSERT_EQ(root->getName(), "GTIC");
+
+    Datapoint* cdc = childAt(root, pivotTemplate.cdc);
+    ASSERT_EQ(cdc->getName(), "SpcTyp");
+
+    ASSERT_EQ(childAt(cdc, pivotTemplate.value)->getName(), "stVal");
+    ASSERT_EQ(childAt(cdc, pivotTemplate.q)->getName(), "q");
+    ASSERT_EQ(childAt(cdc, pivotTemplate.t)->getName(), "t");
+
+    ASSERT_EQ(IEC61850Client::cdcConverter(SPG), nullptr);
+    ASSERT_STREQ(IEC61850Client::valueElementName(MV), "mag");
+    ASSERT_STREQ(IEC61850Client::valueElementName(APC), "mxVal");
+    ASSERT_STREQ(IEC61850Client::valueElementName(BSC), "valWTr");
+    ASSERT_STREQ(IEC61850Client::valueElementName(DPS), "stVal");
+}
+
+TEST_F(PivotTemplateTest, QualityInTemplateCopy) {
+    client = new IEC61850Client(nullptr, config);
+
+    auto def = config->getExchangeDefinitionByLabel("TS1");
+    ASSERT_NE(def, nullptr);
+
+    Quality quality = QUALITY_VALIDITY_GOOD;
+    Quality_setValidity(&quality, QUALITY_VALIDITY_QUESTIONABLE);
+    Quality_setFlag(&quality, QUALITY_DETAIL_OLD_DATA);
+
+    MmsValue* value = MmsValue_newBoolean(false);
+    Datapoint* converted = def->converter(*def, value, "stVal", quality, 1000);
+    ASSERT_NE(converted, nullptr);
+
+    Datapoint* expected =
+        buildReading("GTIS", "TS1", "SpsTyp", valueDp("stVal", 0L));
+    Datapoint* q = childAt(childAt(childAt(expected, 0), 2), 1);
+    childAt(q, 1)->getData() = DatapointValue(string("questionable"));
+    addDp(childAt(q, 2), valueDp("oldData", 1L));
+
+    ASSERT_TRUE(sameTree(converted, expected));
+
+    // the template keeps its placeholders
+    const PivotTemplate& pivotTemplate = *def->pivotTemplate;
+    Datapoint* templateQ = childAt(
+        childAt(childAt(pivotTemplate.pivot.get(), pivotTemplate.root),
+                pivotTemplate.cdc),
+        pivotTemplate.q);
+    ASSERT_EQ(childAt(templateQ, pivotTemplate.validity)
+                  ->getData()
+                  .toStringValue(),
+              "good");
+    ASSERT_EQ(childAt(templateQ, pivotTemplate.detailQuality)
+                  ->getData()
+                  .getDpVec()
+                  ->size(),
+              0);
+
+    delete converted;
+    delete expected;
+    MmsValue_delete(value);
+}
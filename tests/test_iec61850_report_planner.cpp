@@ -0,0 +1,84 @@
+#include <gtest/gtest.h>
+#include <iec61850_report_planner.hpp>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class ReportPlannerTest : public testing::Test
+{
+  protected:
+    void
+    add (const std::string& objRef, CDCTYPE cdcType)
+    {
+        DataExchangeDefinition def{};
+        def.objRef = objRef;
+        def.cdcType = cdcType;
+        definitions.push_back (def);
+    }
+
+    std::unordered_map<std::string, DataExchangeDefinition*>
+    polled ()
+    {
+        std::unordered_map<std::string, DataExchangeDefinition*> result;
+        for (auto& def : definitions)
+            result[def.objRef] = &def;
+        return result;
+    }
+
+    std::vector<DataExchangeDefinition> definitions;
+};
+
+TEST_F (ReportPlannerTest, GroupByLogicalDeviceAndFc)
+{
+    definitions.reserve (5);
+    add ("LD1/GGIO1.AnIn2", MV);
+    add ("LD1/GGIO1.AnIn1", MV);
+    add ("LD1/GGIO1.SPCSO1", SPC);
+    add ("LD2/GGIO1.Ind1", SPS);
+    add ("invalid", SPS);
+
+    std::vector<PlannedDataset> plan
+        = IEC61850ReportPlanner::plan (polled (), 100);
+
+    ASSERT_EQ (plan.size (), 3);
+
+    ASSERT_EQ (plan[0].ldName, "LD1");
+    ASSERT_EQ (plan[0].fc, IEC61850_FC_ST);
+    ASSERT_EQ (plan[0].dataset->datasetRef, "LD1/LLN0.FledgeST0");
+
+    ASSERT_EQ (plan[1].fc, IEC61850_FC_MX);
+    ASSERT_TRUE (plan[1].dataset->dynamic);
+    ASSERT_EQ (plan[1].dataset->entries.size (), 2);
+    ASSERT_EQ (plan[1].dataset->entries[0], "LD1/GGIO1.AnIn1[MX]");
+    ASSERT_EQ (plan[1].dataset->entries[1], "LD1/GGIO1.AnIn2[MX]");
+    ASSERT_EQ (plan[1].definitions[0]->objRef, "LD1/GGIO1.AnIn1");
+
+    ASSERT_EQ (plan[2].dataset->datasetRef, "LD2/LLN0.FledgeST0");
+}
+
+TEST_F (ReportPlannerTest, SizeAndSplit)
+{
+    definitions.reserve (10);
+    for (int i = 0; i < 10; i++)
+        add ("LD1/GGIO1.AnIn" + std::to_string (i), MV);
+
+    std::vector<PlannedDataset> plan
+        = IEC61850ReportPlanner::plan (polled (), 4);
+
+    ASSERT_EQ (plan.size (), 3);
+    ASSERT_EQ (plan[0].definitions.size (), 4);
+    ASSERT_EQ (plan[2].definitions.size (), 2);
+    ASSERT_EQ (plan[1].dataset->datasetRef, "LD1/LLN0.FledgeMX4");
+    ASSERT_EQ (plan[2].dataset->datasetRef, "LD1/LLN0.FledgeMX8");
+
+    PlannedDataset first, second;
+    ASSERT_TRUE (IEC61850ReportPlanner::split (plan[1], first, second));
+    ASSERT_EQ (first.dataset->datasetRef, "LD1/LLN0.FledgeMX4");
+    ASSERT_EQ (second.dataset->datasetRef, "LD1/LLN0.FledgeMX6");
+    ASSERT_EQ (first.definitions.size (), 2);
+    ASSERT_EQ (second.dataset->entries[0], "LD1/GGIO1.AnIn6[MX]");
+
+    PlannedDataset single = first;
+    single.definitions.resize (1);
+    ASSERT_FALSE (IEC61850ReportPlanner::split (single, first, second));
+}
@@ -65,6 +65,108 @@ static string protocol_config = QUOTE ({
     }
 });
 
+static string protocol_config_conversion_pool = QUOTE ({
+    "protocol_stack" : {
+        "name" : "iec61850client",
+        "version" : "0.0.1",
+        "transport_layer" : {
+            "ied_name" : "IED1",
+            "connections" : [ { "ip_addr" : "127.0.0.1", "port" : 10002 } ]
+        },
+        "application_layer" : {
+            "polling_interval" : 0,
+            "conversion_workers" : 2,
+            "datasets" : [
+                {
+                    "dataset_ref" : "simpleIOGenericIO/LLN0.Mags",
+                    "entries" : [
+                        "simpleIOGenericIO/GGIO1.AnIn1[MX]",
+                        "simpleIOGenericIO/GGIO1.AnIn2[MX]",
+                        "simpleIOGenericIO/GGIO1.AnIn3[MX]",
+                        "simpleIOGenericIO/GGIO1.AnIn4[MX]"
+                    ],
+                    "dynamic" : true
+                },
+                {
+                    "dataset_ref" : "simpleIOGenericIO/LLN0.Events2",
+                    "entries" : [
+                        "simpleIOGenericIO/GGIO1.AnIn1.mag.f[MX]",
+                        "simpleIOGenericIO/GGIO1.AnIn2.mag.f[MX]",
+                        "simpleIOGenericIO/GGIO1.AnIn3.mag.f[MX]",
+                        "simpleIOGenericIO/GGIO1.AnIn4.mag.f[MX]"
+                    ],
+                    "dynamic" : false
+                }
+            ],
+            "report_subscriptions" : [
+                {
+                    "rcb_ref" : "simpleIOGenericIO/LLN0.RP.EventsRCB01",
+                    "dataset_ref" : "simpleIOGenericIO/LLN0.Mags",
+                    "trgops" : [ "data_changed", "quality_changed", "gi" ],
+                    "gi" : false
+                },
+                {
+                    "rcb_ref" : "simpleIOGenericIO/LLN0.RP.EventsIndexed01",
+                    "dataset_ref" : "simpleIOGenericIO/LLN0.Events2",
+                    "trgops" : [ "data_changed", "quality_changed", "gi" ],
+                    "gi" : false
+                }
+            ]
+        }
+    }
+});
+
+static string protocol_config_synchronous = QUOTE ({
+    "protocol_stack" : {
+        "name" : "iec61850client",
+        "version" : "0.0.1",
+        "transport_layer" : {
+            "ied_name" : "IED1",
+            "connections" : [ { "ip_addr" : "127.0.0.1", "port" : 10002 } ]
+        },
+        "application_layer" : {
+            "polling_interval" : 0,
+            "report_queue_size" : 0,
+            "datasets" : [
+                {
+                    "dataset_ref" : "simpleIOGenericIO/LLN0.Mags",
+                    "entries" : [
+                        "simpleIOGenericIO/GGIO1.AnIn1[MX]",
+                        "simpleIOGenericIO/GGIO1.AnIn2[MX]",
+                        "simpleIOGenericIO/GGIO1.AnIn3[MX]",
+                        "simpleIOGenericIO/GGIO1.AnIn4[MX]"
+                    ],
+                    "dynamic" : true
+                },
+                {
+                    "dataset_ref" : "simpleIOGenericIO/LLN0.Events2",
+                    "entries" : [
+                        "simpleIOGenericIO/GGIO1.AnIn1.mag.f[MX]",
+                        "simpleIOGenericIO/GGIO1.AnIn2.mag.f[MX]",
+                        "simpleIOGenericIO/GGIO1.AnIn3.mag.f[MX]",
+                        "simpleIOGenericIO/GGIO1.AnIn4.mag.f[MX]"
+                    ],
+                    "dynamic" : false
+                }
+            ],
+            "report_subscriptions" : [
+                {
+                    "rcb_ref" : "simpleIOGenericIO/LLN0.RP.EventsRCB01",
+                    "dataset_ref" : "simpleIOGenericIO/LLN0.Mags",
+                    "trgops" : [ "data_changed", "quality_changed", "gi" ],
+                    "gi" : false
+                },
+                {
+                    "rcb_ref" : "simpleIOGenericIO/LLN0.RP.EventsIndexed01",
+                    "dataset_ref" : "simpleIOGenericIO/LLN0.Events2",
+                    "trgops" : [ "data_changed", "quality_changed", "gi" ],
+                    "gi" : false
+                }
+            ]
+        }
+    }
+});
+
 static string protocol_config_2 = QUOTE ({
     "protocol_stack" : {
         "name" : "iec61850client",
@@ -122,6 +224,22 @@ static string protocol_config_2 = QUOTE ({
 
 // PLUGIN DEFAULT EXCHANGED DATA CONF
 
+static string protocol_config_auto_reporting = QUOTE ({
+    "protocol_stack" : {
+        "name" : "iec61850client",
+        "version" : "0.0.1",
+        "transport_layer" : {
+            "ied_name" : "IED1",
+            "connections" : [ { "ip_addr" : "127.0.0.1", "port" : 10002 } ]
+        },
+        "application_layer" : {
+            "polling_interval" : 1000,
+            "auto_reporting" : true,
+            "max_dataset_entries" : 2
+        }
+    }
+});
+
 static string exchanged_data = QUOTE ({
     "exchanged_data" : {
         "datapoints" : [
@@ -518,6 +636,11 @@ TEST_F (ReportingTest, ReportingWithStaticDataset)
     double expectedMagVal = 1.2;
     verifyDatapoint (mag, "f", &expectedMagVal);
 
+    auto connection = iec61850->m_client->m_active_connection;
+    ASSERT_GE (connection->reportQueueHighWaterMark (), 1);
+    ASSERT_EQ (connection->reportQueueStalls (), 0);
+    ASSERT_GE (connection->timeToFirstReport (), 0);
+
     IedServer_stop (server);
     IedServer_destroy (server);
     IedModel_destroy (model);
@@ -970,4 +1093,354 @@ TEST_F (ReportingTest, ReportingChangeValueMultipleTimes)
     IedServer_stop (server);
     IedServer_destroy (server);
     IedModel_destroy (model);
-}
\ No newline at end of file
+}
+TEST_F (ReportingTest, ReportDispatchTable)
+{
+    iec61850->setJsonConfig (protocol_config, exchanged_data, tls_config);
+
+    IedModel* model = ConfigFileParser_createModelFromConfigFileEx (
+        "../tests/data/simpleIO_direct_control.cfg");
+
+    IedServer server = IedServer_create (model);
+
+    IedServer_start (server, 10002);
+    iec61850->start ();
+
+    Thread_sleep (1000);
+
+    auto start = std::chrono::high_resolution_clock::now ();
+    auto timeout = std::chrono::seconds (5);
+    while (!iec61850->m_client->m_active_connection
+           || !iec61850->m_client->m_active_connection->Connected ())
+    {
+        auto now = std::chrono::high_resolution_clock::now ();
+        if (now - start > timeout)
+        {
+            IedServer_stop (server);
+            IedServer_destroy (server);
+            IedModel_destroy (model);
+            FAIL () << "Connection not established within timeout";
+        }
+        Thread_sleep (10);
+    }
+
+    auto& tables
+        = iec61850->m_client->m_active_connection->m_reportDispatchTables;
+
+    ASSERT_EQ (tables.size (), 2);
+
+    int attributeEntries = 0;
+
+    for (auto table : tables)
+    {
+        ASSERT_EQ (table->entries.size (), 4);
+
+        for (const auto& entry : table->entries)
+        {
+            ASSERT_NE (entry.def, nullptr);
+            ASSERT_EQ (entry.fc, IEC61850_FC_MX);
+            if (entry.attribute == "mag.f")
+                attributeEntries++;
+        }
+    }
+
+    ASSERT_EQ (attributeEntries, 4);
+    ASSERT_EQ (tables[0]->entries[0].def->objRef,
+               "simpleIOGenericIO/GGIO1.AnIn1");
+
+    IedServer_stop (server);
+    IedServer_destroy (server);
+    IedModel_destroy (model);
+}
+
+TEST_F (ReportingTest, ReportingSynchronous)
+{
+    iec61850->setJsonConfig (protocol_config_synchronous, exchanged_data, tls_config);
+
+    IedModel* model = ConfigFileParser_createModelFromConfigFileEx (
+        "../tests/data/simpleIO_direct_control.cfg");
+
+    IedServer server = IedServer_create (model);
+
+    IedServer_start (server, 10002);
+    iec61850->start ();
+
+    Thread_sleep (1000);
+
+    auto start = std::chrono::high_resolution_clock::now ();
+    auto timeout = std::chrono::seconds (5);
+    while (!iec61850->m_client->m_active_connection
+           || !iec61850->m_client->m_active_connection->m_connection
+           || IedConnection_getState (
+                  iec61850->m_client->m_active_connection->m_connection)
+                  != IED_STATE_CONNECTED)
+    {
+        auto now = std::chrono::high_resolution_clock::now ();
+        if (now - start > timeout)
+        {
+            IedServer_stop (server);
+            IedServer_destroy (server);
+            IedModel_destroy (model);
+            FAIL () << "Connection not established within timeout";
+        }
+        Thread_sleep (10);
+    }
+
+    ASSERT_EQ (iec61850->m_client->m_active_connection->m_reportQueue,
+               nullptr);
+
+    IedServer_updateFloatAttributeValue (
+        server,
+        (DataAttribute*)IedModel_getModelNodeByObjectReference (
+            model, "simpleIOGenericIO/GGIO1.AnIn1.mag.f"),
+        1.2);
+
+    timeout = std::chrono::seconds (3);
+    start = std::chrono::high_resolution_clock::now ();
+    while (ingestCallbackCalled != 1)
+    {
+        auto now = std::chrono::high_resolution_clock::now ();
+        if (now - start > timeout)
+        {
+            IedServer_stop (server);
+            IedServer_destroy (server);
+            IedModel_destroy (model);
+            FAIL () << "Callback not called within timeout";
+        }
+        Thread_sleep (10);
+    }
+
+    ASSERT_FALSE (storedReadings.empty ());
+    ASSERT_EQ (storedReadings.size (), 1);
+    Datapoint* commandResponse = storedReadings[0]->getReadingData ()[0];
+    verifyDatapoint (commandResponse, "GTIM");
+    Datapoint* gtim = getChild (*commandResponse, "GTIM");
+
+    verifyDatapoint (gtim, "MvTyp");
+    Datapoint* MV = getChild (*gtim, "MvTyp");
+
+    verifyDatapoint (MV, "mag");
+    Datapoint* mag = getChild (*MV, "mag");
+
+    double expectedMagVal = 1.2;
+    verifyDatapoint (mag, "f", &expectedMagVal);
+
+    IedServer_stop (server);
+    IedServer_destroy (server);
+    IedModel_destroy (model);
+}
+
+TEST_F (ReportingTest, ReportingConversionPool)
+{
+    iec61850->setJsonConfig (protocol_config_conversion_pool, exchanged_data, tls_config);
+
+    IedModel* model = ConfigFileParser_createModelFromConfigFileEx (
+        "../tests/data/simpleIO_direct_control.cfg");
+
+    IedServer server = IedServer_create (model);
+
+    IedServer_start (server, 10002);
+    iec61850->start ();
+
+    Thread_sleep (1000);
+
+    auto start = std::chrono::high_resolution_clock::now ();
+    auto timeout = std::chrono::seconds (5);
+    while (!iec61850->m_client->m_active_connection
+           || !iec61850->m_client->m_active_connection->m_connection
+           || IedConnection_getState (
+                  iec61850->m_client->m_active_connection->m_connection)
+                  != IED_STATE_CONNECTED)
+    {
+        auto now = std::chrono::high_resolution_clock::now ();
+        if (now - start > timeout)
+        {
+            IedServer_stop (server);
+            IedServer_destroy (server);
+            IedModel_destroy (model);
+            FAIL () << "Connection not established within timeout";
+        }
+        Thread_sleep (10);
+    }
+
+    ASSERT_NE (iec61850->m_client->m_conversionPool, nullptr);
+    ASSERT_EQ (iec61850->m_client->m_conversionPool->workerCount (), 2);
+
+    IedServer_updateFloatAttributeValue (
+        server,
+        (DataAttribute*)IedModel_getModelNodeByObjectReference (
+            model, "simpleIOGenericIO/GGIO1.AnIn1.mag.f"),
+        1.2);
+
+    timeout = std::chrono::seconds (3);
+    start = std::chrono::high_resolution_clock::now ();
+    while (ingestCallbackCalled != 1)
+    {
+        auto now = std::chrono::high_resolution_clock::now ();
+        if (now - start > timeout)
+        {
+            IedServer_stop (server);
+            IedServer_destroy (server);
+            IedModel_destroy (model);
+            FAIL () << "Callback not called within timeout";
+        }
+        Thread_sleep (10);
+    }
+
+    ASSERT_FALSE (storedReadings.empty ());
+    ASSERT_EQ (storedReadings.size (), 1);
+    Datapoint* commandResponse = storedReadings[0]->getReadingData ()[0];
+    verifyDatapoint (commandResponse, "GTIM");
+    Datapoint* gtim = getChild (*commandResponse, "GTIM");
+
+    verifyDatapoint (gtim, "MvTyp");
+    Datapoint* MV = getChild (*gtim, "MvTyp");
+
+    verifyDatapoint (MV, "mag");
+    Datapoint* mag = getChild (*MV, "mag");
+
+    double expectedMagVal = 1.2;
+    verifyDatapoint (mag, "f", &expectedMagVal);
+
+    IedServer_stop (server);
+    IedServer_destroy (server);
+    IedModel_destroy (model);
+}
+
+TEST_F (ReportingTest, DynamicDatasetUnchanged)
+{
+    iec61850->setJsonConfig (protocol_config, exchanged_data, tls_config);
+
+    IedModel* model = ConfigFileParser_createModelFromConfigFileEx (
+        "../tests/data/simpleIO_direct_control.cfg");
+
+    IedServer server = IedServer_create (model);
+
+    IedServer_start (server, 10002);
+    iec61850->start ();
+
+    auto start = std::chrono::high_resolution_clock::now ();
+    auto timeout = std::chrono::seconds (5);
+    while (!iec61850->m_client->m_active_connection
+           || !iec61850->m_client->m_active_connection->Connected ())
+    {
+        auto now = std::chrono::high_resolution_clock::now ();
+        if (now - start > timeout)
+        {
+            IedServer_stop (server);
+            IedServer_destroy (server);
+            IedModel_destroy (model);
+            FAIL () << "Connection not established within timeout";
+        }
+        Thread_sleep (10);
+    }
+
+    auto connection = iec61850->m_client->m_active_connection;
+
+    // the dataset created on connect already matches the configuration
+    {
+        std::lock_guard<std::mutex> lock (connection->m_conLock);
+        ASSERT_EQ (connection->m_configDatasets (), 0);
+    }
+
+    IedServer_stop (server);
+    IedServer_destroy (server);
+    IedModel_destroy (model);
+}
+
+TEST_F (ReportingTest, AutoReporting)
+{
+    iec61850->setJsonConfig (protocol_config_auto_reporting, exchanged_data,
+                             tls_config);
+
+    IedModel* model = ConfigFileParser_createModelFromConfigFileEx (
+        "../tests/data/simpleIO_direct_control.cfg");
+
+    IedServer server = IedServer_create (model);
+
+    IedServer_start (server, 10002);
+    iec61850->start ();
+
+    auto start = std::chrono::high_resolution_clock::now ();
+    auto timeout = std::chrono::seconds (5);
+    while (!iec61850->m_client->m_active_connection
+           || !iec61850->m_client->m_active_connection->Connected ())
+    {
+        auto now = std::chrono::high_resolution_clock::now ();
+        if (now - start > timeout)
+        {
+            IedServer_stop (server);
+            IedServer_destroy (server);
+            IedModel_destroy (model);
+            FAIL () << "Connection not established within timeout";
+        }
+        Thread_sleep (10);
+    }
+
+    auto connection = iec61850->m_client->m_active_connection;
+    size_t polled = iec61850->m_config->polledDatapoints ().size ();
+
+    ASSERT_GT (polled, 0);
+    ASSERT_FALSE (connection->m_plannedReports.empty ());
+    ASSERT_FALSE (connection->m_reportedDefinitions.empty ());
+
+    size_t scheduled = 0;
+    for (const auto& schedule : connection->m_pollSchedules)
+    {
+        for (const auto& slice : schedule.slices)
+            scheduled += slice->polledDatapoints.size ();
+    }
+
+    // whatever is reported is no longer polled
+    ASSERT_EQ (scheduled + connection->m_reportedDefinitions.size (), polled);
+
+    for (const auto& planned : connection->m_plannedReports)
+    {
+        ASSERT_LE (planned.definitions.size (), 2);
+        ASSERT_EQ (planned.subscription->datasetRef.find (
+                       "simpleIOGenericIO/LLN0.Fledge"),
+                   0);
+    }
+
+    IedServer_stop (server);
+    IedServer_destroy (server);
+    IedModel_destroy (model);
+}
+
+TEST_F (ReportingTest, ReportQueueFullNotLost)
+{
+    IEC61850ClientConfig* config = new IEC61850ClientConfig ();
+    config->importExchangeConfig (exchanged_data);
+    config->m_reportQueueSize = 4;
+
+    {
+        IEC61850Client client (iec61850, config);
+        IEC61850ClientConnection connection (&client, config, "127.0.0.1",
+                                             10002, false, nullptr);
+
+        IEC61850ClientConnection::ReportEntry entry{
+            &config->ExchangeDefinition ()[0], "", IEC61850_FC_ST
+        };
+        MmsValue* value = MmsValue_newIntegerFromInt32 (1);
+
+        size_t capacity = connection.m_reportQueue->capacity ();
+
+        for (size_t i = 0; i < capacity; i++)
+            connection.m_enqueueReportValue (&entry, value, 0);
+
+        ASSERT_EQ (connection.reportQueueDepth (), capacity);
+        ASSERT_EQ (connection.reportQueueStalls (), 0);
+
+        // the value that does not fit has the backlog delivered first
+        // instead of being dropped
+        connection.m_enqueueReportValue (&entry, value, 0);
+
+        ASSERT_EQ (connection.reportQueueStalls (), 1);
+        ASSERT_EQ (connection.reportQueueDepth (), 1);
+        ASSERT_EQ (connection.reportQueueHighWaterMark (), capacity);
+
+        MmsValue_delete (value);
+    }
+
+    delete config;
+}
@@ -27,6 +27,111 @@ static string protocol_config = QUOTE ({
     }
 });
 
+static string protocol_config_batched = QUOTE ({
+    "protocol_stack" : {
+        "name" : "iec61850client",
+        "version" : "0.0.1",
+        "transport_layer" : {
+            "ied_name" : "IED1",
+            "connections" : [ { "ip_addr" : "127.0.0.1", "port" : 10002 } ]
+        },
+        "application_layer" : {
+            "polling_interval" : 1000,
+            "polling_mode" : "batched"
+        }
+    }
+});
+
+static string protocol_config_minimal_reads = QUOTE ({
+    "protocol_stack" : {
+        "name" : "iec61850client",
+        "version" : "0.0.1",
+        "transport_layer" : {
+            "ied_name" : "IED1",
+            "connections" : [ { "ip_addr" : "127.0.0.1", "port" : 10002 } ]
+        },
+        "application_layer" : {
+            "polling_interval" : 1000,
+            "polling_mode" : "batched",
+            "minimal_reads" : true
+        }
+    }
+});
+
+static string protocol_config_pipelined = QUOTE ({
+    "protocol_stack" : {
+        "name" : "iec61850client",
+        "version" : "0.0.1",
+        "transport_layer" : {
+            "ied_name" : "IED1",
+            "connections" : [ { "ip_addr" : "127.0.0.1", "port" : 10002 } ]
+        },
+        "application_layer" : {
+            "polling_interval" : 1000,
+            "polling_mode" : "pipelined",
+            "max_outstanding_reads" : 4
+        }
+    }
+});
+
+static string protocol_config_polling_groups = QUOTE ({
+    "protocol_stack" : {
+        "name" : "iec61850client",
+        "version" : "0.0.1",
+        "transport_layer" : {
+            "ied_name" : "IED1",
+            "connections" : [ { "ip_addr" : "127.0.0.1", "port" : 10002 } ]
+        },
+        "application_layer" : {
+            "polling_groups" : [ {
+                "name" : "fast",
+                "interval" : 200,
+                "datapoints" : [ "TS1", "TS2" ]
+            } ]
+        }
+    }
+});
+
+static string protocol_config_change_only = QUOTE ({
+    "protocol_stack" : {
+        "name" : "iec61850client",
+        "version" : "0.0.1",
+        "transport_layer" : {
+            "ied_name" : "IED1",
+            "connections" : [ { "ip_addr" : "127.0.0.1", "port" : 10002 } ]
+        },
+        "application_layer" : {
+            "change_only" : true,
+            "polling_groups" : [ {
+                "name" : "fast",
+                "interval" : 200,
+                "datapoints" : [ "TS1", "TS2" ]
+            } ]
+        }
+    }
+});
+
+static string protocol_config_change_only_workers = QUOTE ({
+    "protocol_stack" : {
+        "name" : "iec61850client",
+        "version" : "0.0.1",
+        "transport_layer" : {
+            "ied_name" : "IED1",
+            "connections" : [ { "ip_addr" : "127.0.0.1", "port" : 10002 } ]
+        },
+        "application_layer" : {
+            "change_only" : true,
+            "polling_mode" : "pipelined",
+            "conversion_workers" : 2,
+            "polling_groups" : [ {
+                "name" : "fast",
+                "interval" : 200,
+                "datapoints" : [ "TS1", "TS2" ]
+            } ]
+        }
+    }
+});
+
 // PLUGIN DEFAULT EXCHANGED DATA CONF
 
 static string exchanged_data = QUOTE ({
@@ -302,6 +407,31 @@ static string exchanged_data_2 = QUOTE ({
     }
 });
 
+static string exchanged_data_shared_objref = QUOTE ({
+    "exchanged_data" : {
+        "datapoints" : [
+            {
+                "pivot_id" : "TM1",
+                "label" : "TM1",
+                "protocols" : [ {
+                    "name" : "iec61850",
+                    "objref" : "TEMPLATELD1/GGIO1.AnIn1",
+                    "cdc" : "MvTyp"
+                } ]
+            },
+            {
+                "pivot_id" : "TM2",
+                "label" : "TM2",
+                "protocols" : [ {
+                    "name" : "iec61850",
+                    "objref" : "TEMPLATELD1/GGIO1.AnIn1",
+                    "cdc" : "MvTyp"
+                } ]
+            }
+        ]
+    }
+});
+
 // PLUGIN DEFAULT TLS CONF
 static string tls_config = QUOTE ({
     "tls_conf" : {
@@ -598,6 +728,15 @@ TEST_F (SpontDataTest, Polling)
         Thread_sleep (10);
     }
 
+    auto def = iec61850->m_config->getExchangeDefinitionByLabel ("TM1");
+    ASSERT_NE (def, nullptr);
+    ASSERT_NE (def->spec, nullptr);
+    ASSERT_GE (def->elements.value, 0);
+    ASSERT_GE (def->elements.valueF, 0);
+    ASSERT_GE (def->elements.q, 0);
+    ASSERT_GE (def->elements.t, 0);
+    ASSERT_EQ (def->elements.posVal, -1);
+
     ASSERT_FALSE (storedReadings.empty ());
     ASSERT_EQ (storedReadings.size (), 2);
     Datapoint* commandResponse = storedReadings[0]->getReadingData ()[0];
@@ -637,6 +776,139 @@ TEST_F (SpontDataTest, Polling)
     IedModel_destroy (model);
 }
 
+TEST_F (SpontDataTest, PollingSharedObjRef)
+{
+    iec61850->setJsonConfig (protocol_config_minimal_reads,
+                             exchanged_data_shared_objref, tls_config);
+
+    IedModel* model = ConfigFileParser_createModelFromConfigFileEx (
+        "../tests/data/iec61850fledgetest.cfg");
+
+    IedServer server = IedServer_create (model);
+
+    IedServer_start (server, 10002);
+    iec61850->start ();
+
+    auto start = std::chrono::high_resolution_clock::now ();
+    auto timeout = std::chrono::seconds (5);
+    while (ingestCallbackCalled < 2)
+    {
+        auto now = std::chrono::high_resolution_clock::now ();
+        if (now - start > timeout)
+        {
+            IedServer_stop (server);
+            IedServer_destroy (server);
+            IedModel_destroy (model);
+            FAIL () << "Callback not called within timeout";
+        }
+        Thread_sleep (10);
+    }
+
+    // both labels of the object reference are read with a single request
+    // and each produces a reading of its own
+    auto tm1 = iec61850->m_config->getExchangeDefinitionByLabel ("TM1");
+    ASSERT_NE (tm1, nullptr);
+    ASSERT_TRUE (tm1->minimalItems.empty ());
+
+    ASSERT_EQ (storedReadings[0]->getAssetName (), "TM1");
+    ASSERT_EQ (storedReadings[1]->getAssetName (), "TM2");
+
+    std::string id = "TM2";
+    Datapoint* gtim = getChild (*storedReadings[1]->getReadingData ()[0],
+                                "GTIM");
+    verifyDatapoint (gtim, "Identifier", &id);
+
+    IedServer_stop (server);
+    IedServer_destroy (server);
+    IedModel_destroy (model);
+}
+
+TEST_F (SpontDataTest, PollingSpecsFollowModel)
+{
+    iec61850->setJsonConfig (protocol_config, exchanged_data_2, tls_config);
+
+    IedModel* model = ConfigFileParser_createModelFromConfigFileEx (
+        "../tests/data/iec61850fledgetest.cfg");
+
+    IedServer server = IedServer_create (model);
+
+    IedServer_start (server, 10002);
+    iec61850->start ();
+
+    auto waitForReadings = [this] (int count) {
+        auto start = std::chrono::high_resolution_clock::now ();
+        while (ingestCallbackCalled < count)
+        {
+            if (std::chrono::high_resolution_clock::now () - start
+                > std::chrono::seconds (10))
+                return false;
+            Thread_sleep (10);
+        }
+        return true;
+    };
+
+    if (!waitForReadings (1))
+    {
+        IedServer_stop (server);
+        IedServer_destroy (server);
+        IedModel_destroy (model);
+        FAIL () << "Callback not called within timeout";
+    }
+
+    IEC61850ClientConfig* config = iec61850->m_config;
+    auto def = config->getExchangeDefinitionByLabel ("TM1");
+    ASSERT_NE (def, nullptr);
+
+    MmsVariableSpecification* spec = def->spec;
+    std::string source = config->specSource ();
+    ASSERT_NE (spec, nullptr);
+    ASSERT_NE (source.find ("127.0.0.1:10002"), std::string::npos);
+
+    // same model after a reconnect -> specifications are kept
+    IedServer_stop (server);
+    Thread_sleep (500);
+    IedServer_start (server, 10002);
+
+    int readings = ingestCallbackCalled;
+    if (!waitForReadings (readings + 1))
+    {
+        IedServer_stop (server);
+        IedServer_destroy (server);
+        IedModel_destroy (model);
+        FAIL () << "Callback not called after reconnect";
+    }
+
+    ASSERT_EQ (def->spec, spec);
+    ASSERT_EQ (config->specSource (), source);
+
+    // another model revision -> specifications are read again
+    IedServer_stop (server);
+    IedServer_updateVisibleStringAttributeValue (
+        server,
+        (DataAttribute*)IedModel_getModelNodeByObjectReference (
+            model, "TEMPLATELD1/LLN0.NamPlt.configRev"),
+        (char*)"2");
+    Thread_sleep (500);
+    IedServer_start (server, 10002);
+
+    readings = ingestCallbackCalled;
+    if (!waitForReadings (readings + 1))
+    {
+        IedServer_stop (server);
+        IedServer_destroy (server);
+        IedModel_destroy (model);
+        FAIL () << "Callback not called after model change";
+    }
+
+    ASSERT_NE (config->specSource (), source);
+    ASSERT_NE (def->spec, nullptr);
+    ASSERT_GE (def->elements.value, 0);
+
+    IedServer_stop (server);
+    IedServer_destroy (server);
+    IedModel_destroy (model);
+}
+
 TEST_F (SpontDataTest, PollingAllCDC)
 {
     iec61850->setJsonConfig (protocol_config, exchanged_data, tls_config);
@@ -688,7 +960,466 @@ TEST_F (SpontDataTest, PollingAllCDC)
     ASSERT_FALSE (storedReadings.empty ());
     ASSERT_EQ (storedReadings.size (), 28);
 
+    auto config = iec61850->m_config;
+    auto anIn1
+        = config->getExchangeDefinitionByObjRef ("TEMPLATELD1/GGIO1.AnIn1");
+    auto anIn2
+        = config->getExchangeDefinitionByObjRef ("TEMPLATELD1/GGIO1.AnIn2");
+    auto spcso1
+        = config->getExchangeDefinitionByObjRef ("TEMPLATELD1/GGIO1.SPCSO1");
+    ASSERT_NE (anIn1->spec, nullptr);
+    ASSERT_EQ (anIn1->spec, anIn2->spec);
+    ASSERT_NE (anIn1->spec, spcso1->spec);
+    ASSERT_LT (config->specCache ().size (),
+               config->ExchangeDefinition ().size ());
+
+    IedServer_stop (server);
+    IedServer_destroy (server);
+    IedModel_destroy (model);
+}
+
+TEST_F (SpontDataTest, PollingBatched)
+{
+    iec61850->setJsonConfig (protocol_config_batched, exchanged_data,
+                             tls_config);
+
+    IedModel* model = ConfigFileParser_createModelFromConfigFileEx (
+        "../tests/data/iec61850fledgetest.cfg");
+
+    IedServer server = IedServer_create (model);
+
+    IedServer_start (server, 10002);
+    iec61850->start ();
+
+    Thread_sleep (1000);
+
+    auto start = std::chrono::high_resolution_clock::now ();
+    auto timeout = std::chrono::seconds (5);
+    while (!iec61850->m_client->m_active_connection
+           || !iec61850->m_client->m_active_connection->m_connection
+           || IedConnection_getState (
+                  iec61850->m_client->m_active_connection->m_connection)
+                  != IED_STATE_CONNECTED)
+    {
+        auto now = std::chrono::high_resolution_clock::now ();
+        if (now - start > timeout)
+        {
+            IedServer_stop (server);
+            IedServer_destroy (server);
+            IedModel_destroy (model);
+            FAIL () << "Connection not established within timeout";
+        }
+        Thread_sleep (10);
+    }
+
+    ASSERT_FALSE (
+        iec61850->m_client->m_active_connection->m_pollBatches.empty ());
+
+    timeout = std::chrono::seconds (3);
+    start = std::chrono::high_resolution_clock::now ();
+    while (ingestCallbackCalled != 28)
+    {
+        auto now = std::chrono::high_resolution_clock::now ();
+        if (now - start > timeout)
+        {
+            IedServer_stop (server);
+            IedServer_destroy (server);
+            IedModel_destroy (model);
+            FAIL () << "Callback not called within timeout";
+        }
+        Thread_sleep (10);
+    }
+
+    ASSERT_EQ (storedReadings.size (), 28);
+
+    Datapoint* commandResponse = storedReadings[0]->getReadingData ()[0];
+    ASSERT_TRUE (hasChild (*commandResponse, "GTIM")
+                 || hasChild (*commandResponse, "GTIS")
+                 || hasChild (*commandResponse, "GTIC"));
+
     IedServer_stop (server);
     IedServer_destroy (server);
     IedModel_destroy (model);
 }
+
+TEST_F (SpontDataTest, PollingMinimalReads)
+{
+    iec61850->setJsonConfig (protocol_config_minimal_reads, exchanged_data,
+                             tls_config);
+
+    IedModel* model = ConfigFileParser_createModelFromConfigFileEx (
+        "../tests/data/iec61850fledgetest.cfg");
+
+    IedServer server = IedServer_create (model);
+
+    IedServer_start (server, 10002);
+    iec61850->start ();
+
+    auto start = std::chrono::high_resolution_clock::now ();
+    auto timeout = std::chrono::seconds (5);
+    while (!iec61850->m_client->m_active_connection
+           || !iec61850->m_client->m_active_connection->Connected ())
+    {
+        auto now = std::chrono::high_resolution_clock::now ();
+        if (now - start > timeout)
+        {
+            IedServer_stop (server);
+            IedServer_destroy (server);
+            IedModel_destroy (model);
+            FAIL () << "Connection not established within timeout";
+        }
+        Thread_sleep (10);
+    }
+
+    auto anIn1 = iec61850->m_config->getExchangeDefinitionByObjRef (
+        "TEMPLATELD1/GGIO1.AnIn1");
+    ASSERT_EQ (anIn1->minimalItems.size (), 3);
+    ASSERT_EQ (anIn1->minimalItems[0], "mag");
+    ASSERT_EQ (anIn1->minimalElements.value, 0);
+    ASSERT_EQ (anIn1->minimalElements.q, 1);
+    ASSERT_EQ (anIn1->minimalElements.t, 2);
+    ASSERT_EQ (anIn1->minimalElements.valueF, anIn1->elements.valueF);
+
+    bool minimalBatch = false;
+    for (const auto& batch :
+         iec61850->m_client->m_active_connection->m_pollBatches)
+    {
+        for (int count : batch->itemCounts)
+            minimalBatch = minimalBatch || count == 3;
+    }
+    ASSERT_TRUE (minimalBatch);
+
+    timeout = std::chrono::seconds (3);
+    start = std::chrono::high_resolution_clock::now ();
+    while (ingestCallbackCalled != 28)
+    {
+        auto now = std::chrono::high_resolution_clock::now ();
+        if (now - start > timeout)
+        {
+            IedServer_stop (server);
+            IedServer_destroy (server);
+            IedModel_destroy (model);
+            FAIL () << "Callback not called within timeout";
+        }
+        Thread_sleep (10);
+    }
+
+    ASSERT_EQ (storedReadings.size (), 28);
+
+    Datapoint* commandResponse = storedReadings[0]->getReadingData ()[0];
+    ASSERT_TRUE (hasChild (*commandResponse, "GTIM")
+                 || hasChild (*commandResponse, "GTIS")
+                 || hasChild (*commandResponse, "GTIC"));
+
+    IedServer_stop (server);
+    IedServer_destroy (server);
+    IedModel_destroy (model);
+}
+
+TEST_F (SpontDataTest, PollingPipelined)
+{
+    iec61850->setJsonConfig (protocol_config_pipelined, exchanged_data,
+                             tls_config);
+
+    IedModel* model = ConfigFileParser_createModelFromConfigFileEx (
+        "../tests/data/iec61850fledgetest.cfg");
+
+    IedServer server = IedServer_create (model);
+
+    IedServer_start (server, 10002);
+    iec61850->start ();
+
+    Thread_sleep (1000);
+
+    auto start = std::chrono::high_resolution_clock::now ();
+    auto timeout = std::chrono::seconds (5);
+    while (!iec61850->m_client->m_active_connection
+           || !iec61850->m_client->m_active_connection->m_connection
+           || IedConnection_getState (
+                  iec61850->m_client->m_active_connection->m_connection)
+                  != IED_STATE_CONNECTED)
+    {
+        auto now = std::chrono::high_resolution_clock::now ();
+        if (now - start > timeout)
+        {
+            IedServer_stop (server);
+            IedServer_destroy (server);
+            IedModel_destroy (model);
+            FAIL () << "Connection not established within timeout";
+        }
+        Thread_sleep (10);
+    }
+
+    ASSERT_EQ (
+        iec61850->m_client->m_active_connection->m_pendingReads.size (), 4);
+
+    timeout = std::chrono::seconds (3);
+    start = std::chrono::high_resolution_clock::now ();
+    while (ingestCallbackCalled != 28)
+    {
+        auto now = std::chrono::high_resolution_clock::now ();
+        if (now - start > timeout)
+        {
+            IedServer_stop (server);
+            IedServer_destroy (server);
+            IedModel_destroy (model);
+            FAIL () << "Callback not called within timeout";
+        }
+        Thread_sleep (10);
+    }
+
+    ASSERT_EQ (storedReadings.size (), 28);
+
+    Datapoint* commandResponse = storedReadings[0]->getReadingData ()[0];
+    ASSERT_TRUE (hasChild (*commandResponse, "GTIM")
+                 || hasChild (*commandResponse, "GTIS")
+                 || hasChild (*commandResponse, "GTIC"));
+
+    IedServer_stop (server);
+    IedServer_destroy (server);
+    IedModel_destroy (model);
+}
+
+TEST_F (SpontDataTest, PollingGroups)
+{
+    iec61850->setJsonConfig (protocol_config_polling_groups, exchanged_data,
+                             tls_config);
+
+    IedModel* model = ConfigFileParser_createModelFromConfigFileEx (
+        "../tests/data/iec61850fledgetest.cfg");
+
+    IedServer server = IedServer_create (model);
+
+    IedServer_start (server, 10002);
+    iec61850->start ();
+
+    auto start = std::chrono::high_resolution_clock::now ();
+    auto timeout = std::chrono::seconds (3);
+    while (ingestCallbackCalled < 6)
+    {
+        auto now = std::chrono::high_resolution_clock::now ();
+        if (now - start > timeout)
+        {
+            IedServer_stop (server);
+            IedServer_destroy (server);
+            IedModel_destroy (model);
+            FAIL () << "Callback not called within timeout";
+        }
+        Thread_sleep (10);
+    }
+
+    for (auto reading : storedReadings)
+    {
+        ASSERT_TRUE (reading->getAssetName () == "TS1"
+                     || reading->getAssetName () == "TS2");
+    }
+
+    IedServer_stop (server);
+    IedServer_destroy (server);
+    IedModel_destroy (model);
+}
+
+TEST_F (SpontDataTest, PollingScheduleCadence)
+{
+    iec61850->setJsonConfig (protocol_config_polling_groups, exchanged_data,
+                             tls_config);
+
+    IedModel* model = ConfigFileParser_createModelFromConfigFileEx (
+        "../tests/data/iec61850fledgetest.cfg");
+
+    IedServer server = IedServer_create (model);
+
+    IedServer_start (server, 10002);
+    iec61850->start ();
+
+    auto start = std::chrono::high_resolution_clock::now ();
+    auto timeout = std::chrono::seconds (3);
+    while (ingestCallbackCalled < 2)
+    {
+        auto now = std::chrono::high_resolution_clock::now ();
+        if (now - start > timeout)
+        {
+            IedServer_stop (server);
+            IedServer_destroy (server);
+            IedModel_destroy (model);
+            FAIL () << "Callback not called within timeout";
+        }
+        Thread_sleep (10);
+    }
+
+    auto connection = iec61850->m_client->m_active_connection;
+
+    ASSERT_EQ (connection->m_pollSchedules.size (), 1);
+    ASSERT_EQ (connection->m_pollSchedules[0].slices.size (), 2);
+
+    uint64_t firstDeadline = connection->m_pollSchedules[0].nextPollingTime;
+
+    Thread_sleep (1000);
+
+    uint64_t secondDeadline = connection->m_pollSchedules[0].nextPollingTime;
+
+    ASSERT_GT (secondDeadline, firstDeadline);
+    ASSERT_EQ ((secondDeadline - firstDeadline) % 200, 0);
+    ASSERT_EQ (connection->m_pollSchedules[0].overruns, 0);
+
+    IedServer_stop (server);
+    IedServer_destroy (server);
+    IedModel_destroy (model);
+}
+
+TEST_F (SpontDataTest, PollingChangeOnly)
+{
+    iec61850->setJsonConfig (protocol_config_change_only, exchanged_data,
+                             tls_config);
+
+    IedModel* model = ConfigFileParser_createModelFromConfigFileEx (
+        "../tests/data/iec61850fledgetest.cfg");
+
+    IedServer server = IedServer_create (model);
+
+    IedServer_start (server, 10002);
+    iec61850->start ();
+
+    auto start = std::chrono::high_resolution_clock::now ();
+    auto timeout = std::chrono::seconds (3);
+    while (ingestCallbackCalled < 2)
+    {
+        auto now = std::chrono::high_resolution_clock::now ();
+        if (now - start > timeout)
+        {
+            IedServer_stop (server);
+            IedServer_destroy (server);
+            IedModel_destroy (model);
+            FAIL () << "Callback not called within timeout";
+        }
+        Thread_sleep (10);
+    }
+
+    Thread_sleep (1000);
+
+    // values did not change on the server -> only the first poll is forwarded
+    ASSERT_EQ (ingestCallbackCalled, 2);
+
+    IedServer_stop (server);
+    IedServer_destroy (server);
+    IedModel_destroy (model);
+}
+
+TEST_F (SpontDataTest, PollingChangeOnlyReconnect)
+{
+    iec61850->setJsonConfig (protocol_config_change_only_workers,
+                             exchanged_data, tls_config);
+
+    IedModel* model = ConfigFileParser_createModelFromConfigFileEx (
+        "../tests/data/iec61850fledgetest.cfg");
+
+    IedServer server = IedServer_create (model);
+
+    IedServer_start (server, 10002);
+    iec61850->start ();
+
+    auto start = std::chrono::high_resolution_clock::now ();
+    auto timeout = std::chrono::seconds (3);
+    while (ingestCallbackCalled < 2)
+    {
+        auto now = std::chrono::high_resolution_clock::now ();
+        if (now - start > timeout)
+        {
+            IedServer_stop (server);
+            IedServer_destroy (server);
+            IedModel_destroy (model);
+            FAIL () << "Callback not called within timeout";
+        }
+        Thread_sleep (10);
+    }
+
+    // the last polled values are released while reads and conversions of
+    // the lost connection may still be completing
+    IedServer_stop (server);
+    Thread_sleep (500);
+    IedServer_start (server, 10002);
+
+    // the first poll after the reconnect is forwarded again
+    start = std::chrono::high_resolution_clock::now ();
+    timeout = std::chrono::seconds (10);
+    while (ingestCallbackCalled < 4)
+    {
+        auto now = std::chrono::high_resolution_clock::now ();
+        if (now - start > timeout)
+        {
+            IedServer_stop (server);
+            IedServer_destroy (server);
+            IedModel_destroy (model);
+            FAIL () << "Callback not called after reconnect";
+        }
+        Thread_sleep (10);
+    }
+
+    IedServer_stop (server);
+    IedServer_destroy (server);
+    IedModel_destroy (model);
+}
+
+TEST (PivotTimestampTest, StackOnlyEncoding)
+{
+    static_assert (PivotTimestamp::EncodeSecondSinceEpoch (1700566837999ULL)
+                       == 1700566837,
+                   "seconds must be computed at compile time");
+    static_assert (PivotTimestamp::EncodeFractionOfSecond (999ULL)
+                       == 999 * 16777 + (999 * 216) / 1000,
+                   "fraction must be computed at compile time");
+
+    for (uint64_t ms : { 0ULL, 1ULL, 500ULL, 999ULL, 1700566837015ULL,
+                         1700566837999ULL })
+    {
+        PivotTimestamp ts (ms);
+
+        ASSERT_EQ (ts.SecondSinceEpoch (),
+                   (int)PivotTimestamp::EncodeSecondSinceEpoch (ms));
+        ASSERT_EQ (ts.FractionOfSecond (),
+                   (int)PivotTimestamp::EncodeFractionOfSecond (ms));
+        ASSERT_EQ (ts.getTimeInMs (), ms);
+    }
+}
+
+TEST_F (SpontDataTest, PolledValueChangedElements)
+{
+    IEC61850ClientConfig* config = new IEC61850ClientConfig ();
+    config->importProtocolConfig (protocol_config_change_only);
+
+    IEC61850Client client (iec61850, config);
+
+    DataExchangeDefinition def{};
+    def.elements.value = 0;
+    def.elements.q = 1;
+    def.elements.t = 2;
+
+    // value, q, t and one more attribute of the functional constraint
+    auto dataObject = [] (int value, int q, int t, int ctlNum) {
+        MmsValue* mmsValue = MmsValue_createEmptyStructure (4);
+        MmsValue_setElement (mmsValue, 0, MmsValue_newIntegerFromInt32 (value));
+        MmsValue_setElement (mmsValue, 1, MmsValue_newIntegerFromInt32 (q));
+        MmsValue_setElement (mmsValue, 2, MmsValue_newIntegerFromInt32 (t));
+        MmsValue_setElement (mmsValue, 3,
+                             MmsValue_newIntegerFromInt32 (ctlNum));
+        return mmsValue;
+    };
+
+    MmsValue* first = dataObject (1, 0, 100, 0);
+    MmsValue* otherAttribute = dataObject (1, 0, 100, 1);
+    MmsValue* quality = dataObject (1, 64, 100, 1);
+    MmsValue* timestamp = dataObject (1, 64, 200, 1);
+
+    ASSERT_TRUE (client.m_polledValueChanged (&def, first, ""));
+    ASSERT_FALSE (client.m_polledValueChanged (&def, otherAttribute, ""));
+    ASSERT_TRUE (client.m_polledValueChanged (&def, quality, ""));
+    ASSERT_TRUE (client.m_polledValueChanged (&def, timestamp, ""));
+    ASSERT_FALSE (client.m_polledValueChanged (&def, timestamp, ""));
+
+    MmsValue_delete (first);
+    MmsValue_delete (otherAttribute);
+    MmsValue_delete (quality);
+    MmsValue_delete (timestamp);
+    MmsValue_delete (def.lastPolledValue);
+    delete config;
+}